@@ -0,0 +1,87 @@
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "benchutils.h"
+#include "blocklist.h"
+
+namespace {
+
+using Bench::nsPerOp;
+
+constexpr size_t OPS = 10000;
+
+template <typename List>
+List makeList(size_t n) {
+    List l;
+    for (size_t i = 0; i < n; ++i)
+        l.insertBack(static_cast<int>(i));
+    return l;
+}
+
+template <typename List>
+double randomReads(size_t n) {
+    List l = makeList<List>(n);
+    std::mt19937 rng(1);
+    long long sum{};
+    const double res = nsPerOp(OPS, [&] {
+        for (size_t i = 0; i < OPS; ++i)
+            sum += l[rng() % n];
+    });
+    Bench::keep(sum);
+    return res;
+}
+
+template <typename List>
+double randomInserts(size_t n) {
+    List l = makeList<List>(n);
+    std::mt19937 rng(2);
+    return nsPerOp(OPS, [&] {
+        for (size_t i = 0; i < OPS; ++i)
+            l.insert(rng() % (l.size() + 1), static_cast<int>(i));
+    });
+}
+
+template <typename List>
+double randomErases(size_t n) {
+    List l = makeList<List>(n + OPS);
+    std::mt19937 rng(3);
+    return nsPerOp(OPS, [&] {
+        for (size_t i = 0; i < OPS; ++i)
+            l.erase(rng() % l.size());
+    });
+}
+
+using SparseList  = BlockList<int, BlockListIndex::Sparse>;
+using CountedList = BlockList<int, BlockListIndex::Counted>;
+
+template <typename Fn>
+void row(const std::string &name, size_t n, Fn sparse, Fn counted) {
+    const double s = sparse(n);
+    const double c = counted(n);
+    std::cout << std::left << std::setw(16) << name
+              << std::right << std::setw(10) << n
+              << std::setw(14) << std::fixed << std::setprecision(1) << s
+              << std::setw(14) << c
+              << std::setw(10) << std::setprecision(2) << s / c << "x\n";
+}
+
+}
+
+int main()
+{
+    std::cout << std::left << std::setw(16) << "workload"
+              << std::right << std::setw(10) << "size"
+              << std::setw(14) << "sparse ns/op"
+              << std::setw(14) << "counted ns/op"
+              << std::setw(11) << "speedup" << "\n";
+
+    for (size_t n : {size_t(1e4), size_t(1e5), size_t(1e6)}) {
+        row("random read",   n, randomReads<SparseList>,   randomReads<CountedList>);
+        row("random insert", n, randomInserts<SparseList>, randomInserts<CountedList>);
+        row("random erase",  n, randomErases<SparseList>,  randomErases<CountedList>);
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include "benchutils.h"
+#include "blocklist.h"
+
+namespace {
+
+struct Record {
+    std::array<int64_t, 8> fields{};
+};
+
+}
+
+template <> Record Bench::makeItem<Record>(size_t i) { Record r; r.fields[0] = i; return r; }
+
+namespace {
+
+using Bench::makeItem;
+using Bench::nsPerOp;
+using Bench::weigh;
+
+constexpr size_t SIZE = 200000;
+constexpr size_t OPS  = 20000;
+
+size_t weigh(const Record &item) { return static_cast<size_t>(item.fields[0]); }
+
+template <typename T, uint16_t CAPACITY>
+void sweepOne(const char *typeName) {
+    using List = BlockList<T, BlockListIndex::Counted, CAPACITY>;
+
+    List l;
+    const double build = nsPerOp(SIZE, [&] {
+        for (size_t i = 0; i < SIZE; ++i)
+            l.insertBack(makeItem<T>(i));
+    });
+
+    std::mt19937 rng(1);
+    size_t touched{};
+    const double scan = nsPerOp(SIZE, [&] {
+        for (size_t i = 0; i < l.size(); ++i)
+            touched += weigh(l[i]);
+    });
+
+    const double read = nsPerOp(OPS, [&] {
+        for (size_t i = 0; i < OPS; ++i)
+            touched += weigh(l[rng() % l.size()]);
+    });
+
+    const double insert = nsPerOp(OPS, [&] {
+        for (size_t i = 0; i < OPS; ++i)
+            l.insert(rng() % (l.size() + 1), makeItem<T>(i));
+    });
+
+    const double erase = nsPerOp(OPS, [&] {
+        for (size_t i = 0; i < OPS; ++i)
+            l.erase(rng() % l.size());
+    });
+
+    std::cout << std::left << std::setw(12) << typeName
+              << std::right << std::setw(6) << CAPACITY
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << build
+              << std::setw(10) << scan
+              << std::setw(10) << read
+              << std::setw(10) << insert
+              << std::setw(10) << erase
+              << (CAPACITY == Details::defaultBlockCapacity<T>() ? "  (default)" : "")
+              << "\n";
+
+    Bench::keep(touched);
+}
+
+template <typename T, uint16_t... CAPACITIES>
+void sweep(const char *typeName, std::integer_sequence<uint16_t, CAPACITIES...>) {
+    (sweepOne<T, CAPACITIES>(typeName), ...);
+    std::cout << "\n";
+}
+
+using Capacities = std::integer_sequence<uint16_t, 4, 8, 16, 32, 64, 128, 256, 512, 1024>;
+
+}
+
+int main()
+{
+    std::cout << "ns/op, " << SIZE << " elements, " << OPS << " random ops\n";
+    std::cout << std::left << std::setw(12) << "type"
+              << std::right << std::setw(6) << "cap"
+              << std::setw(10) << "build"
+              << std::setw(10) << "scan"
+              << std::setw(10) << "read"
+              << std::setw(10) << "insert"
+              << std::setw(10) << "erase" << "\n";
+
+    sweep<int>("int", Capacities{});
+    sweep<std::string>("std::string", Capacities{});
+    sweep<Record>("Record(64B)", Capacities{});
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include "benchutils.h"
+#include "blocklist.h"
+#include "mappedblocklist.h"
+
+using Bench::millis;
+
+// Usage: blocklist_io_bench [items] [file]
+int main(int argc, char *argv[])
+{
+    const size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000000;
+    const std::string path = argc > 2 ? argv[2] : "blocklist_io_bench.bin";
+
+    BlockList<int64_t> source;
+    const double build = millis([&] {
+        for (size_t i = 0; i < size; ++i)
+            source.insertBack(int64_t(i));
+    });
+
+    const double save = millis([&] { source.save(path); });
+
+    // What a reload used to cost: one insertBack per item read back
+    BlockList<int64_t> copied;
+    const double rebuild = millis([&] {
+        for (size_t i = 0; i < source.size(); ++i)
+            copied.insertBack(source[i]);
+    });
+
+    BlockList<int64_t> loaded;
+    const double load = millis([&] { loaded.load(path); });
+
+    int64_t sum{};
+    double map{}, scan{};
+    {
+        std::optional<MappedBlockList<int64_t>> mapped;
+        map = millis([&] { mapped.emplace(path); });
+        scan = millis([&] {
+            for (int64_t x : *mapped)
+                sum += x;
+        });
+    }
+    std::remove(path.c_str());
+
+    std::cout << std::fixed << std::setprecision(1)
+              << size << " int64 items, " << size * sizeof(int64_t) / (1 << 20) << " MiB\n"
+              << "insertBack build:     " << build   << " ms\n"
+              << "save:                 " << save    << " ms\n"
+              << "operator[]+insertBack " << rebuild << " ms\n"
+              << "load:                 " << load    << " ms\n"
+              << "map:                  " << map     << " ms\n"
+              << "first scan of map:    " << scan    << " ms\n";
+
+    if (loaded.size() != size || sum != int64_t(size) * (int64_t(size) - 1) / 2) {
+        std::cout << "Mismatch after reload\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "benchutils.h"
+#include "blocklist.h"
+#include "blocklistparallel.h"
+
+namespace {
+
+using Bench::millis;
+
+// Best of a few runs, the first one also warms the pool up
+template <typename Fn>
+double bestOf(Fn &&fn) {
+    double best = millis(fn);
+    for (int i = 0; i < 2; ++i)
+        best = std::min(best, millis(fn));
+    return best;
+}
+
+}
+
+// Usage: blocklist_parallel_bench [items] [max threads]
+int main(int argc, char *argv[])
+{
+    const size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000000;
+    const size_t maxThreads = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                       : std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    std::vector<double> source(size);
+    std::iota(source.begin(), source.end(), 0.0);
+    BlockList<double> l(source.begin(), source.end());
+    std::vector<double> dest(size);
+
+    std::cout << size << " doubles, ms (speedup vs 1 thread)\n";
+    std::cout << std::left << std::setw(10) << "threads"
+              << std::right << std::setw(20) << "forEach"
+              << std::setw(20) << "reduce"
+              << std::setw(20) << "transform" << "\n";
+
+    double base[3]{};
+    double checksum{};
+    for (size_t threads : threadCounts) {
+        ThreadPool pool(threads);
+
+        const double results[3] = {
+            bestOf([&] { parallelForEach(l, [](double &x) { x += 1.0; }, pool); }),
+            bestOf([&] { checksum += parallelReduce(l, 0.0, [](double a, double b) { return a + b; }, pool); }),
+            bestOf([&] { parallelTransform(l, dest.begin(), [](double x) { return std::sqrt(x) * std::log1p(x); }, pool); }),
+        };
+
+        std::cout << std::left << std::setw(10) << threads << std::right;
+        for (int i = 0; i < 3; ++i) {
+            if (threads == 1)
+                base[i] = results[i];
+            std::cout << std::setw(11) << std::fixed << std::setprecision(1) << results[i]
+                      << " (" << std::setw(5) << std::setprecision(2) << base[i] / results[i] << "x)";
+        }
+        std::cout << "\n";
+    }
+
+    Bench::keep(checksum + dest[0]);
+
+    return 0;
+}
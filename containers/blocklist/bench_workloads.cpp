@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "benchutils.h"
+#include "blocklist.h"
+#include "nlist.h"
+#include "nvector.h"
+#include "tableprinter.h"
+
+// Live heap bytes, kept by the replaced global allocation functions below.
+// Every block carries its size and the start of the malloc'd area in front
+// of the pointer handed out.
+namespace {
+
+size_t liveBytes{};
+
+struct AllocHeader {
+    void  *raw;
+    size_t size;
+};
+
+void *countedNew(size_t size, size_t align) {
+    align = std::max(align, alignof(std::max_align_t));
+    void *raw = std::malloc(size + align + sizeof(AllocHeader));
+    if (!raw)
+        throw std::bad_alloc();
+
+    const auto start = reinterpret_cast<uintptr_t>(raw) + sizeof(AllocHeader);
+    void *user = reinterpret_cast<void*>((start + align - 1) & ~(uintptr_t(align) - 1));
+    static_cast<AllocHeader*>(user)[-1] = {raw, size};
+
+    liveBytes += size;
+    return user;
+}
+
+void countedDelete(void *user) noexcept {
+    if (!user)
+        return;
+
+    const AllocHeader header = static_cast<AllocHeader*>(user)[-1];
+    liveBytes -= header.size;
+    std::free(header.raw);
+}
+
+}
+
+void *operator new(size_t size)                        { return countedNew(size, 0); }
+void *operator new(size_t size, std::align_val_t align) { return countedNew(size, size_t(align)); }
+void operator delete(void *p) noexcept                         { countedDelete(p); }
+void operator delete(void *p, size_t) noexcept                 { countedDelete(p); }
+void operator delete(void *p, std::align_val_t) noexcept       { countedDelete(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { countedDelete(p); }
+
+namespace {
+
+using Bench::Clock;
+
+constexpr double CELL_BUDGET_NS = 20e6;
+constexpr size_t MAX_OPS = 1000000;
+
+// A node per item takes tens of bytes, so the node-based lists stop here
+constexpr size_t MAX_NODE_LIST_SIZE = 10000000;
+
+// Uniform interface over the benchmarked containers
+template <typename List>
+struct BlockListAdapter {
+    List l;
+
+    size_t size() const            { return l.size(); }
+    int  read(size_t pos) const    { return l[pos]; }
+    void pushFront(int v)          { l.insertFront(v); }
+    void pushBack(int v)           { l.insertBack(v); }
+    void insert(size_t pos, int v) { l.insert(pos, v); }
+    void erase(size_t pos)         { l.erase(pos); }
+};
+
+template <typename Std>
+struct StdAdapter {
+    Std l;
+
+    size_t size() const            { return l.size(); }
+    int  read(size_t pos) const    { return *std::next(l.begin(), pos); }
+    void pushFront(int v)          { l.insert(l.begin(), v); }
+    void pushBack(int v)           { l.push_back(v); }
+    void insert(size_t pos, int v) { l.insert(std::next(l.begin(), pos), v); }
+    void erase(size_t pos)         { l.erase(std::next(l.begin(), pos)); }
+};
+
+struct NListAdapter {
+    NList<int> l;
+
+    size_t size() const            { return l.size(); }
+    int  read(size_t pos) const    { return *std::next(l.begin(), pos); }
+    void pushFront(int v)          { l.insertFront(v); }
+    void pushBack(int v)           { l.insertBack(v); }
+    void insert(size_t pos, int v) { l.insert(std::next(l.cbegin(), pos), v); }
+    void erase(size_t pos)         { l.erase(std::next(l.begin(), pos)); }
+};
+
+// NVector<int> takes its storage from malloc, which the counters above miss
+struct NVectorAdapter {
+    NVector<int> l;
+
+    size_t heapBytes() const       { return l.capacity() * sizeof(int); }
+
+    size_t size() const            { return l.size(); }
+    int  read(size_t pos) const    { return l[pos]; }
+    void pushFront(int v)          { l.insert(0, v); }
+    void pushBack(int v)           { l.pushBack(v); }
+    void insert(size_t pos, int v) { l.insert(pos, v); }
+    void erase(size_t pos)         { l.erase(pos); }
+};
+
+// Adapters whose container allocates past operator new report their bytes
+template <typename Adapter, typename = void>
+struct ReportsBytes : std::false_type {};
+
+template <typename Adapter>
+struct ReportsBytes<Adapter, std::void_t<decltype(std::declval<const Adapter&>().heapBytes())>>
+    : std::true_type {};
+
+enum Workload {
+    RandomRead,
+    SequentialScan,
+    FrontInsert,
+    BackInsert,
+    MiddleInsert,
+    RandomErase,
+    Mixed,
+    WORKLOAD_COUNT
+};
+
+const char *const WORKLOAD_NAMES[WORKLOAD_COUNT] = {
+    "random_read", "sequential_scan", "front_insert", "back_insert",
+    "middle_insert", "random_erase", "mixed"
+};
+
+struct Result {
+    std::string container;
+    size_t size{};
+    double bytesPerItem{};
+    double nsPerOp[WORKLOAD_COUNT]{};
+};
+
+size_t sink{};
+
+// Runs fn(count) in doubling batches until the time budget or 'maxOps' is
+// used up, so linear-time operations on big containers stay affordable
+template <typename Fn>
+double measure(size_t maxOps, Fn &&fn) {
+    size_t done{};
+    double elapsed{};
+    for (size_t batch = 1; done < maxOps && elapsed < CELL_BUDGET_NS; batch *= 2) {
+        batch = std::min(batch, maxOps - done);
+        const auto start = Clock::now();
+        fn(batch);
+        elapsed += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        done += batch;
+    }
+    return elapsed / done;
+}
+
+template <typename Adapter>
+Result run(const std::string &name, size_t n) {
+    Result result{name, n};
+
+    const size_t before = liveBytes;
+    Adapter a;
+    for (size_t i = 0; i < n; ++i)
+        a.pushBack(static_cast<int>(i));
+    if constexpr (ReportsBytes<Adapter>::value)
+        result.bytesPerItem = double(a.heapBytes()) / n;
+    else
+        result.bytesPerItem = double(liveBytes - before) / n;
+
+    std::mt19937_64 rng(n);
+    // Inserts and erases are capped so the size stays close to n
+    const size_t growth = std::max<size_t>(1, std::min(MAX_OPS, n / 8));
+
+    result.nsPerOp[RandomRead] = measure(MAX_OPS, [&](size_t ops) {
+        for (size_t i = 0; i < ops; ++i)
+            sink += a.read(rng() % a.size());
+    });
+
+    result.nsPerOp[SequentialScan] = measure(MAX_OPS, [&](size_t ops) {
+        for (size_t done = 0; done < ops;)
+            for (int x : a.l) {
+                sink += x;
+                if (++done == ops) break;
+            }
+    });
+
+    result.nsPerOp[Mixed] = measure(MAX_OPS, [&](size_t ops) {
+        // Half reads, a quarter each of inserts and erases
+        for (size_t i = 0; i < ops; ++i) {
+            const uint64_t r = rng();
+            if (r % 4 == 0 || a.size() <= n / 2)
+                a.insert(r / 4 % (a.size() + 1), static_cast<int>(i));
+            else if (r % 4 == 1)
+                a.erase(r / 4 % a.size());
+            else
+                sink += a.read(r / 4 % a.size());
+        }
+    });
+
+    result.nsPerOp[FrontInsert] = measure(growth, [&](size_t ops) {
+        for (size_t i = 0; i < ops; ++i)
+            a.pushFront(static_cast<int>(i));
+    });
+
+    result.nsPerOp[BackInsert] = measure(growth, [&](size_t ops) {
+        for (size_t i = 0; i < ops; ++i)
+            a.pushBack(static_cast<int>(i));
+    });
+
+    result.nsPerOp[MiddleInsert] = measure(growth, [&](size_t ops) {
+        for (size_t i = 0; i < ops; ++i)
+            a.insert(a.size() / 2, static_cast<int>(i));
+    });
+
+    result.nsPerOp[RandomErase] = measure(2 * growth, [&](size_t ops) {
+        for (size_t i = 0; i < ops; ++i)
+            a.erase(rng() % a.size());
+    });
+
+    return result;
+}
+
+std::string fixed(double value, int precision) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(precision) << value;
+    return os.str();
+}
+
+void printTable(const std::vector<Result> &results) {
+    TablePrinter table(std::cout);
+    table.addColumn("container", 18);
+    table.addColumn("size", 10);
+    for (const char *name : WORKLOAD_NAMES)
+        table.addColumn(name, 15);
+    table.addColumn("bytes/item", 10);
+
+    std::cout << "ns/op, int items\n";
+    table.printHeader();
+    for (const Result &r : results) {
+        table << r.container << r.size;
+        for (double ns : r.nsPerOp)
+            table << fixed(ns, 1);
+        table << fixed(r.bytesPerItem, 2);
+    }
+}
+
+void writeJson(std::ostream &os, const std::vector<Result> &results) {
+    os << "{\n  \"item\": \"int\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result &r = results[i];
+        os << "    {\"container\": \"" << r.container << "\", \"size\": " << r.size
+           << ", \"bytes_per_item\": " << r.bytesPerItem << ", \"ns_per_op\": {";
+        for (size_t w = 0; w < WORKLOAD_COUNT; ++w) {
+            os << (w ? ", " : "") << "\"" << WORKLOAD_NAMES[w] << "\": " << r.nsPerOp[w];
+        }
+        os << "}}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+}
+
+// Usage: blocklist_workload_bench [max size] [json file]
+int main(int argc, char *argv[])
+{
+    const size_t maxSize = argc > 1 ? size_t(std::strtod(argv[1], nullptr)) : size_t(1e7);
+    const std::string jsonPath = argc > 2 ? argv[2] : "blocklist_workload_bench.json";
+
+    std::vector<Result> results;
+    for (size_t n = 1000; n <= maxSize; n *= 10) {
+        results.push_back(run<BlockListAdapter<BlockList<int, BlockListIndex::Sparse>>>("BlockList sparse", n));
+        results.push_back(run<BlockListAdapter<BlockList<int, BlockListIndex::Counted>>>("BlockList counted", n));
+        results.push_back(run<BlockListAdapter<BlockList<int, BlockListIndex::Dense>>>("BlockList dense", n));
+        results.push_back(run<BlockListAdapter<BlockList<int, BlockListIndex::None>>>("BlockList none", n));
+        const bool nodeLists = n <= MAX_NODE_LIST_SIZE;
+        if (nodeLists)
+            results.push_back(run<NListAdapter>("NList", n));
+        results.push_back(run<NVectorAdapter>("NVector", n));
+        results.push_back(run<StdAdapter<std::vector<int>>>("std::vector", n));
+        results.push_back(run<StdAdapter<std::deque<int>>>("std::deque", n));
+        if (nodeLists)
+            results.push_back(run<StdAdapter<std::list<int>>>("std::list", n));
+    }
+
+    printTable(results);
+
+    std::ofstream json(jsonPath);
+    writeJson(json, results);
+    std::cout << "JSON written to " << jsonPath << "\n";
+
+    Bench::keep(sink);
+
+    return 0;
+}
@@ -1,18 +1,40 @@
+#ifndef BLOCKLIST_H
+#define BLOCKLIST_H
 
 #include <cstddef>
 #include <cstdint>
-#include <array>
+#include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-//TO DO
-//удаление без полного переделывания таблицы
-
 namespace Details {
 
+// Blocks aim at this many bytes of payload, but never hold less than
+// MIN_BLOCK_CAPACITY elements
+constexpr size_t BLOCK_TARGET_BYTES = 1024;
+constexpr size_t MIN_BLOCK_CAPACITY = 4;
+
+template <typename T>
+constexpr uint16_t defaultBlockCapacity() {
+    const size_t fit = BLOCK_TARGET_BYTES / sizeof(T);
+    if (fit < MIN_BLOCK_CAPACITY) return MIN_BLOCK_CAPACITY;
+    if (fit > UINT16_MAX)         return UINT16_MAX;
+    return static_cast<uint16_t>(fit);
+}
+
 struct BlockListNodeBase {
     BlockListNodeBase() = default;
 
@@ -20,108 +42,264 @@ struct BlockListNodeBase {
     BlockListNodeBase *prev{this};
 };
 
-template <typename T>
-class BlockListNode : public BlockListNodeBase
+struct EmptyIndexHook {};
+
+struct CountedIndexHook {
+    CountedIndexHook *parent{};
+    CountedIndexHook *left{};
+    CountedIndexHook *right{};
+    size_t   total{};       // elements in the subtree
+    uint32_t priority{};
+};
+
+template <typename T, typename Hook, uint16_t CAPACITY>
+class BlockListNode : public BlockListNodeBase, public Hook
 {
+    static_assert(CAPACITY > 0, "Block capacity must be positive");
+
+    // Items live in raw storage: only [0, count_) are constructed objects
+    static constexpr bool TRIVIAL = std::is_trivially_copyable_v<T>;
+
 public:
-    static constexpr uint16_t SIZE = 4;
+    static constexpr uint16_t SIZE = CAPACITY;
+
+    BlockListNode() = default;
+    BlockListNode(const BlockListNode &other) = delete;
+    BlockListNode &operator=(const BlockListNode &other) = delete;
+
+    ~BlockListNode() {
+        destroy(0, count_);
+    }
 
     uint16_t count()  const { return count_; }
     bool     filled() const { return count_ == SIZE; }
     bool     empty()  const { return count_ == 0; }
 
-    template <typename U>
-    void set(size_t pos, U &&item) {
-        items_[pos] = std::forward<U>(item);
-    }
-
     T &at(size_t pos) {
         if (pos >= count_)
             throw std::out_of_range("Index out of bounds;");
-        return items_[pos];
+        return data()[pos];
     }
 
     const T &at(size_t pos) const {
         if (pos >= count_)
             throw std::out_of_range("Index out of bounds;");
-        return items_[pos];
+        return data()[pos];
     }
 
+    T &operator[](size_t pos)             { return data()[pos]; }
+    const T &operator[](size_t pos) const { return data()[pos]; }
+
     T &last() {
-        return items_[SIZE - 1];
+        return data()[count_ - 1];
     }
 
     template <typename U>
     void pushFront(U &&item) {
-        if (count_ >= SIZE)
-            throw std::out_of_range("Index out of bounds;");
-
-        if (count_ > 0)
-            shiftRight();
-
-        items_[0] = std::forward<U>(item);
-        ++count_;
+        emplace(0, std::forward<U>(item));
     }
 
     template <typename U>
     void pushBack(U &&item) {
-        if (count_ >= SIZE)
-            throw std::out_of_range("Index out of bounds;");
-
-        items_[count_] = std::forward<U>(item);
-        ++count_;
+        emplace(count_, std::forward<U>(item));
     }
 
     template <typename U>
     void push(size_t pos, U &&item) {
+        emplace(pos, std::forward<U>(item));
+    }
+
+    // Constructs the item from args right in slot 'pos'
+    template <typename... Args>
+    T &emplace(size_t pos, Args &&...args) {
         if (count_ >= SIZE)
             throw std::out_of_range("Index out of bounds;");
 
-        if (count_ > 0)
+        // An argument may live in the part of this block that gets shifted
+        if ((holds(std::addressof(args), pos) || ...)) {
+            T value(std::forward<Args>(args)...);
+            shiftRight(pos);
+            new (data() + pos) T(std::move(value));
+        } else {
             shiftRight(pos);
+            try {
+                new (data() + pos) T(std::forward<Args>(args)...);
+            } catch (...) {
+                // Close the gap again, the shifted items end at count_ + 1
+                ++count_;
+                shiftLeft(pos);
+                --count_;
+                throw;
+            }
+        }
 
-        items_[pos] = std::forward<U>(item);
         ++count_;
+        return data()[pos];
+    }
+
+    // Whether 'address' lies within the items [from, count())
+    bool holds(const void *address, size_t from = 0) const {
+        const std::less<const void*> before;
+        return !before(address, data() + from) && before(address, data() + count_);
     }
 
     void erase(size_t pos) {
         if (empty())
             throw std::out_of_range("Node is empty");
 
-        if (pos == SIZE - 1) {
-            items_[pos] = T{};
-            --count_;
-            return;
+        data()[pos].~T();
+        shiftLeft(pos);
+        --count_;
+    }
+
+    void erase(size_t first, size_t last) {
+        destroy(first, last);
+        shiftLeft(first, last - first);
+        count_ -= last - first;
+    }
+
+    // Appends [from, count_) to the end of dst
+    void moveTailTo(BlockListNode &dst, size_t from) {
+        const size_t n = count_ - from;
+        relocate(dst.data() + dst.count_, data() + from, n);
+        dst.count_ += n;
+        count_ = from;
+    }
+
+    // Prepends [from, count_) to the front of dst
+    void moveTailToFront(BlockListNode &dst, size_t from) {
+        const size_t n = count_ - from;
+        dst.shiftRight(0, n);
+        relocate(dst.data(), data() + from, n);
+        dst.count_ += n;
+        count_ = from;
+    }
+
+    // Appends the first n items to the end of dst
+    void moveHeadTo(BlockListNode &dst, size_t n) {
+        relocate(dst.data() + dst.count_, data(), n);
+        dst.count_ += n;
+        shiftLeft(0, n);
+        count_ -= n;
+    }
+
+    // Appends items until the node is full, returns where it stopped
+    template <typename InputIt>
+    InputIt pushBackRange(InputIt first, InputIt last) {
+        if constexpr (TRIVIAL && std::is_same_v<std::decay_t<InputIt>, const T*>) {
+            const size_t n = std::min<size_t>(SIZE - count_, last - first);
+            std::memcpy(data() + count_, first, n * sizeof(T));
+            count_ += n;
+            return first + n;
+        } else {
+            while (count_ < SIZE && first != last) {
+                new (data() + count_) T(*first);
+                ++count_;
+                ++first;
+            }
+            return first;
         }
+    }
 
-        for (int i = pos; i < SIZE - 1; ++i)
-            items_[i] = std::move_if_noexcept(items_[i + 1]);
-        --count_;
+    // Lets fill(bytes, size) write n more items behind the last one. Only
+    // for trivially copyable items, the count grows once fill() returns.
+    template <typename Fill>
+    void fillBack(size_t n, Fill fill) {
+        static_assert(TRIVIAL, "Items must be trivially copyable");
+        fill(static_cast<void*>(data() + count_), n * sizeof(T));
+        count_ += n;
     }
 
-    void shiftRight(size_t start = 0) {
-        for (int i = SIZE - 1; i > start; --i)
-            items_[i] = std::move_if_noexcept(items_[i - 1]);
+    void popBack() {
+        if (empty())
+            throw std::out_of_range("Node is empty");
+
+        --count_;
+        data()[count_].~T();
     }
 
 #ifdef DEBUG
     void printItems() const {
-        for (auto el : items_) {
-            std::cout << el;
+        for (size_t i = 0; i < count_; ++i) {
+            std::cout << data()[i];
         }
     }
 #endif
 
 private:
-    size_t count_{};
-    std::array<T, SIZE> items_{};
+    T *data() {
+        return std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    const T *data() const {
+        return std::launder(reinterpret_cast<const T*>(storage_));
+    }
+
+    // Moves [start, count_) n slots to the right, [start, start + n) is left raw
+    void shiftRight(size_t start, size_t n = 1) {
+        if (n == 0) return;
+
+        T *items = data();
+        if constexpr (TRIVIAL) {
+            std::memmove(items + start + n, items + start, (count_ - start) * sizeof(T));
+        } else {
+            for (size_t i = count_; i > start; --i) {
+                new (items + i - 1 + n) T(std::move_if_noexcept(items[i - 1]));
+                items[i - 1].~T();
+            }
+        }
+    }
+
+    // Fills the raw slots [start, start + n) by moving the rest n slots to the left
+    void shiftLeft(size_t start, size_t n = 1) {
+        if (n == 0) return;
+
+        T *items = data();
+        if constexpr (TRIVIAL) {
+            std::memmove(items + start, items + start + n, (count_ - start - n) * sizeof(T));
+        } else {
+            for (size_t i = start + n; i < count_; ++i) {
+                new (items + i - n) T(std::move_if_noexcept(items[i]));
+                items[i].~T();
+            }
+        }
+    }
+
+    // Moves n items into raw, non-overlapping storage
+    static void relocate(T *dst, T *src, size_t n) {
+        if constexpr (TRIVIAL) {
+            std::memcpy(dst, src, n * sizeof(T));
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                new (dst + i) T(std::move_if_noexcept(src[i]));
+                src[i].~T();
+            }
+        }
+    }
+
+    void destroy(size_t first, size_t last) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            T *items = data();
+            for (size_t i = first; i < last; ++i)
+                items[i].~T();
+        }
+    }
+
+    uint16_t count_{};
+    alignas(T) unsigned char storage_[sizeof(T) * SIZE];
 };
 
-template <typename NodeItemType, size_t CAPACITY>
+// Sparse table of (start index, node) rows. Lookups land on the closest row
+// and walk the remaining nodes, every row after an edit is shifted.
+// Rows of erased nodes are handed over to a neighbour. When the rows drift
+// apart a replacement table is built in the background, REBUILD_BUDGET node
+// hops per maintain() call, so no single operation walks the whole list.
+template <typename Node, size_t CAPACITY>
 class IndexTable
 {
     using NodeBase   = Details::BlockListNodeBase;
-    using Node       = Details::BlockListNode<NodeItemType>;
+
+    static constexpr size_t REBUILD_BUDGET = 16;
 
 private:
     struct TableRow {
@@ -141,17 +319,30 @@ private:
 
     using RowVector = std::vector<TableRow>;
 
+    // Incremental rebuild state, 'node' is the next node to be considered
+    struct Rebuild {
+        bool active{};
+        RowVector table{};
+        NodeBase *node{};
+        size_t nodeStart{};
+        size_t threshold{};
+        size_t step{};
+    };
+
     RowVector table_{};
+    Rebuild rebuild_{};
 
 public:
     IndexTable() { table_.reserve(CAPACITY); }
     IndexTable(const IndexTable &other) = default;
-    IndexTable(IndexTable &&other) : table_(std::move(other.table_)) {}
+    IndexTable(IndexTable &&other)
+        : table_(std::move(other.table_)), rebuild_(std::move(other.rebuild_)) {}
 
 
     IndexTable &operator=(const IndexTable &other) = default;
     IndexTable &operator=(IndexTable &&other) noexcept {
         table_ = std::move(other.table_);
+        rebuild_ = std::move(other.rebuild_);
         return *this;
     }
 
@@ -170,10 +361,11 @@ public:
         return it != table_.end();
     }
 
-    size_t capacity() const { return CAPACITY; }
-    size_t count()    const { return table_.size(); }
-    bool   filled()   const { return table_.size() >= CAPACITY; }
-    bool   empty()    const { return table_.size() == 0; }
+    size_t capacity()   const { return CAPACITY; }
+    size_t count()      const { return table_.size(); }
+    bool   filled()     const { return table_.size() >= CAPACITY; }
+    bool   empty()      const { return table_.size() == 0; }
+    bool   rebuilding() const { return rebuild_.active; }
 
     const TableRow &findClosest(size_t index) const {
         if (empty())
@@ -188,80 +380,203 @@ public:
         return *it;
     }
 
+    // First node for which before(node) is false, nullptr when there is
+    // none. The rows are searched first, then the chain from the last row
+    // still before.
+    template <typename Pred>
+    TableRow partitionPoint(Pred before, NodeBase *sent) const {
+        if (empty())
+            return {};
+
+        const auto rowBefore = [&before](const TableRow &row) {
+            return before(*row.node);
+        };
+        auto it = std::partition_point(table_.begin(), table_.end(), rowBefore);
+        if (it == table_.begin())
+            return *it;
+
+        --it;
+        size_t index = it->index;
+        NodeBase *base = it->node;
+        while (base != sent && before(*static_cast<Node*>(base))) {
+            index += static_cast<Node*>(base)->count();
+            base = base->next;
+        }
+        return {index, base != sent ? static_cast<Node*>(base) : nullptr};
+    }
+
     void insert(size_t index, Node *node) {
         if (filled())
             throw std::out_of_range("Table is filled");
 
-        table_.push_back({index, node});
-        std::sort(table_.begin(), table_.end(), [](const TableRow &a, const TableRow &b) {
-            return a.index < b.index;
-        });
+        insertRow(table_, index, node);
     }
 
-    /*NOT READY
-    // void eraseIfContains(size_t index) {
-    //     const auto pred = [index](const TableRow &row) {
-    //         return row.index == index;
-    //     };
-    //     const auto it = std::find_if(table_.begin(), table_.end(), pred);
-    //     if (it == table_.end()) return;
-
-    //     table_.erase(it);
-    //     decrementAfter(it);
-    // }*/
-
     void update(size_t elemIndex, size_t newIndex, Node *newNode) {
         table_[elemIndex] = {newIndex, newNode};
     }
 
-    void incrementAll() {
-        for (auto &el : table_) {
-            ++el.index;
+    void adjust(Node *, size_t nodeStart, std::ptrdiff_t delta) {
+        shiftAfter(table_, nodeStart, delta);
+
+        if (rebuild_.active) {
+            shiftAfter(rebuild_.table, nodeStart, delta);
+            if (rebuild_.nodeStart > nodeStart)
+                rebuild_.nodeStart += delta;
+        }
+    }
+
+    void insertNode(Node *node, Node *, size_t nodeStart) {
+        shiftFrom(table_, nodeStart, node->count());
+
+        if (!filled())
+            insert(nodeStart, node);
+        else if (nodeStart == 0)
+            update(0, 0, node);
+
+        if (rebuild_.active) {
+            RowVector &shadow = rebuild_.table;
+            shiftFrom(shadow, nodeStart, node->count());
+            if (nodeStart == 0 && shadow.size() < CAPACITY)
+                insertRow(shadow, 0, node);
+            else if (nodeStart == 0 && !shadow.empty())
+                shadow.front() = {0, node};
+
+            if (rebuild_.nodeStart >= nodeStart && rebuild_.node != node)
+                rebuild_.nodeStart += node->count();
         }
     }
 
-    void incrementAfter(size_t index) {
-        const auto pred = [index](const TableRow &row) {
-            return row.index > index;
-        };
-        auto it = std::find_if(table_.begin(), table_.end(), pred);
-        while (it != table_.end()) {
-            ++it->index;
-            ++it;
+    // Called while the node is still linked
+    void eraseNode(Node *node, size_t nodeStart) {
+        const std::ptrdiff_t delta = -std::ptrdiff_t(node->count());
+
+        shiftAfter(table_, nodeStart, delta);
+        eraseIfContains(table_, node, nodeStart);
+
+        if (rebuild_.active) {
+            shiftAfter(rebuild_.table, nodeStart, delta);
+            eraseIfContains(rebuild_.table, node, nodeStart);
+
+            if (rebuild_.node == node)
+                rebuild_.node = node->next;
+            else if (rebuild_.nodeStart > nodeStart)
+                rebuild_.nodeStart += delta;
         }
     }
 
-    void incrementAfter(typename RowVector::iterator it) {
-        while (it != table_.end()) {
-            ++it->index;
-            ++it;
+    // [first, last] is linked right where it holds the items from 'start' on
+    void insertRange(Node *first, Node *, size_t start, size_t items) {
+        shiftFrom(table_, start, items);
+
+        if (!filled())
+            insert(start, first);
+        else if (start == 0)
+            update(0, 0, first);
+
+        rebuild_ = Rebuild{};
+    }
+
+    // Called while [first, last] is still linked, the rows of the dropped
+    // blocks go away and the head row moves on to the block after them
+    void eraseRange(Node *first, Node *last, size_t start, size_t items) {
+        const auto from = std::lower_bound(table_.begin(), table_.end(), start, CompareRowIndex{});
+        const auto to = std::lower_bound(from, table_.end(), start + items, CompareRowIndex{});
+        shiftFrom(table_, start + items, -std::ptrdiff_t(items));
+        table_.erase(from, to);
+
+        const bool remains = last->next != first->prev;
+        if (start == 0 && remains && (empty() || table_.front().index != 0)) {
+            if (!filled())
+                insertRow(table_, 0, static_cast<Node*>(last->next));
+            else
+                update(0, 0, static_cast<Node*>(last->next));
         }
+
+        rebuild_ = Rebuild{};
     }
 
-    void decrementAfter(size_t index) {
-        const auto pred = [index](const TableRow &row) {
-            return row.index > index;
-        };
-        auto it = std::find_if(table_.begin(), table_.end(), pred);
-        while (it != table_.end()) {
-            --it->index;
-            ++it;
+    // Moves the rows from 'start' on to dst, 'first' is the block at 'start'
+    void splitOff(IndexTable &dst, Node *first, size_t start) {
+        dst.clear();
+
+        const auto from = std::lower_bound(table_.begin(), table_.end(), start, CompareRowIndex{});
+        for (auto it = from; it != table_.end(); ++it)
+            dst.table_.push_back({it->index - start, it->node});
+        table_.erase(from, table_.end());
+
+        if (dst.empty() || dst.table_.front().index != 0) {
+            if (!dst.filled())
+                insertRow(dst.table_, 0, first);
+            else
+                dst.update(0, 0, first);
         }
+
+        rebuild_ = Rebuild{};
     }
 
-    void decrementAfter(typename RowVector::iterator it) {
-        while (it != table_.end()) {
-            --it->index;
-            ++it;
+    // Takes over the rows of a chain linked behind the last 'offset' items
+    void append(IndexTable &other, size_t offset) {
+        for (const TableRow &row : other.table_) {
+            if (filled())
+                break;
+            table_.push_back({row.index + offset, row.node});
+        }
+
+        other.clear();
+        rebuild_ = Rebuild{};
+    }
+
+    // Advances a pending rebuild or starts one when the rows drifted apart
+    void maintain(NodeBase *sent, size_t total) {
+        if (!rebuild_.active) {
+            if (!degraded(total))
+                return;
+            startRebuild(sent, total);
+        }
+
+        Rebuild &r = rebuild_;
+        size_t budget = REBUILD_BUDGET;
+        while (r.table.size() < CAPACITY && r.threshold < total) {
+            while (r.node != sent && r.nodeStart + static_cast<Node*>(r.node)->count() <= r.threshold) {
+                if (budget-- == 0)
+                    return;
+                r.nodeStart += static_cast<Node*>(r.node)->count();
+                r.node = r.node->next;
+            }
+            if (r.node == sent) break;
+
+            insertRow(r.table, r.nodeStart, static_cast<Node*>(r.node));
+            r.threshold = nextThreshold(r);
         }
+
+        if (!r.table.empty() && r.table.front().index == 0)
+            table_.swap(r.table);
+        r = Rebuild{};
     }
 
-    void erase(size_t index) {
-        table_.erase(index);
+    void rebuild(NodeBase *sent, size_t total) {
+        rebuild_ = Rebuild{};
+        startRebuild(sent, total);
+        table_.clear();
+
+        Rebuild &r = rebuild_;
+        while(table_.size() < CAPACITY && r.threshold < total) {
+            while (r.node != sent && r.nodeStart + static_cast<Node*>(r.node)->count() <= r.threshold) {
+                r.nodeStart += static_cast<Node*>(r.node)->count();
+                r.node = r.node->next;
+            }
+            if (r.node == sent) break;
+
+            insertRow(table_, r.nodeStart, static_cast<Node*>(r.node));
+            r.threshold = nextThreshold(r);
+        }
+        r = Rebuild{};
     }
 
     void clear() {
         table_.clear();
+        rebuild_ = Rebuild{};
     }
 
 #ifdef DEBUG
@@ -270,234 +585,1891 @@ public:
             std::cout << el.index << "\n";
     }
 #endif
-};
 
-}
+private:
+    static void insertRow(RowVector &rows, size_t index, Node *node) {
+        const auto it = std::upper_bound(rows.begin(), rows.end(), index, CompareRowIndex{});
+        rows.insert(it, {index, node});
+    }
 
-template <typename T>
-class BlockList
-{
-    static constexpr uint16_t TABLE_CAP = 7;
-    using IndexTable = Details::IndexTable<T, TABLE_CAP>;
+    static void shiftAfter(RowVector &rows, size_t index, std::ptrdiff_t delta) {
+        auto it = std::upper_bound(rows.begin(), rows.end(), index, CompareRowIndex{});
+        for (; it != rows.end(); ++it)
+            it->index += delta;
+    }
 
-    using NodeBase   = Details::BlockListNodeBase;
-    using Node       = Details::BlockListNode<T>;
+    static void shiftFrom(RowVector &rows, size_t index, std::ptrdiff_t delta) {
+        auto it = std::lower_bound(rows.begin(), rows.end(), index, CompareRowIndex{});
+        for (; it != rows.end(); ++it)
+            it->index += delta;
+    }
 
-    friend class Details::BlockListNode<T>;
+    // Hands the row of a dying node to its predecessor, or to its successor
+    // when the node is the head. A neighbour that already has a row keeps it.
+    static void eraseIfContains(RowVector &rows, Node *node, size_t nodeStart) {
+        auto it = std::lower_bound(rows.begin(), rows.end(), nodeStart, CompareRowIndex{});
+        while (it != rows.end() && it->index == nodeStart && it->node != node)
+            ++it;
+        if (it == rows.end() || it->node != node) return;
 
-public:
-    BlockList()
-        : size_(0), sent_(new NodeBase) {}
+        if (node->next == node->prev) {
+            rows.erase(it);
+            return;
+        }
 
-    BlockList(const BlockList &other)
-        : size_(0), sent_(new NodeBase)
-    {
-        for (size_t i = 0; i < other.size_; ++i)
-            insertBack(other[i]);
-    }
+        if (nodeStart == 0) {
+            Node *next = static_cast<Node*>(node->next);
+            const auto after = it + 1;
+            if (after != rows.end() && after->node == next)
+                rows.erase(it);
+            else
+                *it = {0, next};
+            return;
+        }
 
-    BlockList(BlockList &&other) noexcept
-        : size_(other.size_), sent_(other.sent_), table_(std::move(other.table_))
-    {
-        other.sent_ = new NodeBase;
-        other.size_ = 0;
+        Node *prev = static_cast<Node*>(node->prev);
+        if (it != rows.begin() && (it - 1)->node == prev)
+            rows.erase(it);
+        else
+            *it = {nodeStart - prev->count(), prev};
     }
 
-    BlockList(const std::initializer_list<T> &initList)
-        : size_(0), sent_(new NodeBase)
-    {
-        for (const T &el : initList)
-            insertBack(el);
+    // Rows are expected every total/CAPACITY items, give or take a block
+    bool degraded(size_t total) const {
+        if (table_.empty())
+            return total > 0;
+
+        const size_t allowed = 2 * (total / CAPACITY + Node::SIZE);
+        size_t prev = table_.front().index;
+        for (const auto &row : table_) {
+            if (row.index - prev > allowed)
+                return true;
+            prev = row.index;
+        }
+        return total - prev > allowed;
     }
 
-    ~BlockList() {
-        clear();
-        delete sent_;
+    // A block wider than the step would otherwise get a row per step
+    static size_t nextThreshold(const Rebuild &r) {
+        return std::max(r.threshold + r.step,
+                        r.nodeStart + static_cast<Node*>(r.node)->count());
     }
 
-    const T &operator[](size_t pos) const {
-        if (pos >= size_)
-            throw std::out_of_range("Index out of bounds");
-
-        Node *node = findNode(pos, pos);
-        return node->at(pos);
+    void startRebuild(NodeBase *sent, size_t total) {
+        rebuild_.active = true;
+        rebuild_.table.clear();
+        rebuild_.table.reserve(CAPACITY);
+        rebuild_.node = sent->next;
+        rebuild_.nodeStart = 0;
+        rebuild_.threshold = 0;
+        rebuild_.step = (total + CAPACITY) / CAPACITY;
     }
+};
 
-    T &operator[](size_t pos) {
-        if (pos >= size_)
-            throw std::out_of_range("Index out of bounds");
-
-        Node *node = findNode(pos, pos);
-        return node->at(pos);
-    }
+// Treap over the node chain ordered by list position. Every node is a tree
+// vertex and keeps the element count of its subtree, so a position lookup is
+// a descent from the root and a count change is a walk up to it.
+template <typename Node>
+class CountedIndex
+{
+    using NodeBase   = Details::BlockListNodeBase;
+    using Hook       = Details::CountedIndexHook;
 
-    BlockList &operator=(const BlockList &other) {
-        if (this == &other) return *this;
+public:
+    struct Location {
+        size_t index{};
+        Node *node{};
+    };
 
-        clear();
-        for (size_t i = 0; i < other.size_; ++i)
-            insertBack(other[i]);
+    CountedIndex() = default;
+    CountedIndex(const CountedIndex &other) = delete;
+    CountedIndex(CountedIndex &&other) noexcept
+        : root_(std::exchange(other.root_, nullptr)), seed_(other.seed_) {}
 
+    CountedIndex &operator=(const CountedIndex &other) = delete;
+    CountedIndex &operator=(CountedIndex &&other) noexcept {
+        root_ = std::exchange(other.root_, nullptr);
+        seed_ = other.seed_;
         return *this;
     }
 
-    BlockList &operator=(BlockList &&other) noexcept {
-        if (this == &other) return *this;
+    bool   empty() const { return root_ == nullptr; }
+    size_t total() const { return total(root_); }
 
-        clear();
-        delete sent_;
+    Location findClosest(size_t pos) const {
+        if (empty())
+            throw std::out_of_range("Index is empty");
+
+        const Hook *curr = root_;
+        size_t start{};
+        while (curr) {
+            const size_t left = total(curr->left);
+            if (pos < left) {
+                curr = curr->left;
+                continue;
+            }
 
-        size_ = other.size_;
-        sent_ = other.sent_;
-        table_ = std::move(other.table_);
-        other.sent_ = new NodeBase;
-        other.size_ = 0;
-        other.table_.clear();
+            const size_t passed = curr->total - total(curr->right);
+            if (pos < passed)
+                return {start + left, toNode(curr)};
 
-        return *this;
+            pos -= passed;
+            start += passed;
+            curr = curr->right;
+        }
+        throw std::out_of_range("Index out of bounds");
     }
 
-    BlockList &operator=(const std::initializer_list<T> &initList) {
-        clear();
-        for (const T &el : initList)
-            insertBack(el);
-
-        return *this;
+    // First node for which before(node) is false, nullptr when there is none
+    template <typename Pred>
+    Location partitionPoint(Pred before, NodeBase *) const {
+        Location found{};
+        const Hook *curr = root_;
+        size_t start{};
+        while (curr) {
+            const size_t left = total(curr->left);
+            Node *node = toNode(curr);
+            if (before(*node)) {
+                start += left + node->count();
+                curr = curr->right;
+            } else {
+                found = {start + left, node};
+                curr = curr->left;
+            }
+        }
+        return found;
     }
 
-    T &at(size_t i)             { return operator[](i); }
-    const T &at(size_t i) const { return operator[](i); }
-
-    size_t size()  const { return size_; }
-    bool   empty() const { return sent_->next == sent_; }
+    void adjust(Node *node, size_t, std::ptrdiff_t delta) {
+        for (Hook *h = node; h; h = h->parent)
+            h->total += delta;
+    }
 
-    template <typename U>
-    void insertFront(U &&item) {
-        ++size_;
+    // The node is already linked into the list right after 'after'
+    // (nullptr when it became the head)
+    void insertNode(Node *node, Node *after, size_t) {
+        Hook *h = node;
+        h->left = h->right = h->parent = nullptr;
+        h->total = node->count();
+        h->priority = nextPriority();
 
-        Node *head = static_cast<Node *>(sent_->next);
-        if (empty()) {
-            initFirstNode(std::forward<U>(item));
+        if (!root_) {
+            root_ = h;
             return;
         }
 
-        if (!head->filled()) {
-            head->pushFront(std::forward<U>(item));
-            table_.incrementAfter(0);
-            return;
+        Hook *parent{};
+        if (!after) {
+            parent = leftmost(root_);
+            parent->left = h;
+        } else if (!static_cast<Hook*>(after)->right) {
+            parent = after;
+            parent->right = h;
+        } else {
+            parent = leftmost(static_cast<Hook*>(after)->right);
+            parent->left = h;
         }
+        h->parent = parent;
 
-        Node *add = new Node;
-        add->pushFront(std::forward<U>(item));
+        for (Hook *p = parent; p; p = p->parent)
+            p->total += h->total;
 
-        insertNodeBetween(sent_, add, head);
+        while (h->parent && h->parent->priority < h->priority)
+            rotateUp(h);
+    }
 
-        if (!table_.filled()) {
-            table_.incrementAll();
-            table_.insert(0, add);
-        } else {
-            table_.update(0, 0, add);
-            table_.incrementAfter(0);
+    void eraseNode(Node *node, size_t) {
+        Hook *h = node;
+        while (h->left || h->right) {
+            Hook *child{};
+            if (!h->left)
+                child = h->right;
+            else if (!h->right)
+                child = h->left;
+            else
+                child = h->left->priority > h->right->priority ? h->left : h->right;
+            rotateUp(child);
         }
+
+        const size_t own = h->total;
+        replaceChild(h->parent, h, nullptr);
+        for (Hook *p = h->parent; p; p = p->parent)
+            p->total -= own;
+
+        h->parent = nullptr;
     }
 
-    template <typename U>
-    void insertBack(U &&item) {
-        ++size_;
+    // [first, last] is linked right where it holds the items from 'start' on
+    void insertRange(Node *first, Node *last, size_t start, size_t) {
+        const auto [before, after] = split(root_, start);
+        root_ = merge(merge(before, build(first, last->next)), after);
+        root_->parent = nullptr;
+    }
 
-        if (empty()) {
-            initFirstNode(std::forward<U>(item));
-            return;
-        }
+    void eraseRange(Node *, Node *, size_t start, size_t items) {
+        const auto [before, rest] = split(root_, start);
+        const auto [dropped, after] = split(rest, items);
+        (void)dropped;
+        root_ = merge(before, after);
+        if (root_)
+            root_->parent = nullptr;
+    }
 
-        Node *tail = static_cast<Node *>(sent_->prev);
-        if (!tail->filled()) {
-            tail->pushBack(std::forward<U>(item));
-            return;
-        }
+    // Moves the nodes from 'start' on into dst, which must be empty
+    void splitOff(CountedIndex &dst, Node *, size_t start) {
+        const auto [before, after] = split(root_, start);
+        root_ = before;
+        dst.root_ = after;
+        if (root_)
+            root_->parent = nullptr;
+        if (dst.root_)
+            dst.root_->parent = nullptr;
+    }
 
-        Node *add = new Node;
-        add->pushBack(std::forward<U>(item));
+    void append(CountedIndex &other, size_t) {
+        root_ = merge(root_, std::exchange(other.root_, nullptr));
+        if (root_)
+            root_->parent = nullptr;
+    }
 
-        insertNodeBetween(tail, add, sent_);
+    void maintain(NodeBase *, size_t) {}
 
-        if (!table_.filled())
-            table_.insert(size_ - 1, add);
+    void rebuild(NodeBase *sent, size_t) {
+        root_ = build(sent->next, sent);
     }
 
-    template <typename U>
-    void insert(size_t pos, U &&item) {
-        if (pos > size_)
-            throw std::out_of_range("Index out of bounds");
+    void clear() {
+        root_ = nullptr;
+    }
 
-        if (pos == 0) {
-            insertFront(std::forward<U>(item));
-            return;
-        }
+#ifdef DEBUG
+    void printTableIndexes() const {
+        size_t start{};
+        printSubtree(root_, start);
+    }
+#endif
 
-        if (pos == size_) {
-            insertBack(std::forward<U>(item));
-            return;
+private:
+    // Builds a treap over [first, end) in one pass (Cartesian tree on a stack)
+    Hook *build(NodeBase *first, NodeBase *end) {
+        std::vector<Hook*> stack;
+        for (NodeBase *base = first; base != end; base = base->next) {
+            Node *node = static_cast<Node*>(base);
+            Hook *h = node;
+            h->left = h->right = h->parent = nullptr;
+            h->total = node->count();
+            h->priority = nextPriority();
+
+            Hook *last{};
+            while (!stack.empty() && stack.back()->priority < h->priority) {
+                last = stack.back();
+                stack.pop_back();
+                finalize(last);
+            }
+
+            h->left = last;
+            if (last)
+                last->parent = h;
+            if (!stack.empty()) {
+                stack.back()->right = h;
+                h->parent = stack.back();
+            }
+            stack.push_back(h);
         }
 
-        ++size_;
+        Hook *root = stack.empty() ? nullptr : stack.front();
+        while (!stack.empty()) {
+            finalize(stack.back());
+            stack.pop_back();
+        }
+        return root;
+    }
 
-        size_t indexInNode{};
-        Node *curr = findNode(pos, indexInNode);
-        if (!curr->filled()) {
-            curr->push(indexInNode, std::forward<U>(item));
-            table_.incrementAfter(pos);
-            return;
+    // Splits into the nodes before 'pos' and the rest, 'pos' has to be a
+    // node boundary. Parent links of the two roots are left to the caller.
+    static std::pair<Hook*, Hook*> split(Hook *h, size_t pos) {
+        if (!h)
+            return {};
+
+        if (pos <= total(h->left)) {
+            const auto [before, rest] = split(h->left, pos);
+            h->total -= total(before);
+            h->left = rest;
+            if (rest)
+                rest->parent = h;
+            return {before, h};
         }
 
-        T lastItem = std::move_if_noexcept(curr->last());
-        curr->shiftRight(indexInNode);
-        curr->set(indexInNode, std::forward<U>(item));
+        const size_t passed = h->total - total(h->right);
+        const auto [rest, after] = split(h->right, pos - passed);
+        h->total -= total(after);
+        h->right = rest;
+        if (rest)
+            rest->parent = h;
+        return {h, after};
+    }
+
+    static Hook *merge(Hook *a, Hook *b) {
+        if (!a) return b;
+        if (!b) return a;
+
+        if (a->priority > b->priority) {
+            a->total += b->total;
+            a->right = merge(a->right, b);
+            a->right->parent = a;
+            return a;
+        }
+
+        b->total += a->total;
+        b->left = merge(a, b->left);
+        b->left->parent = b;
+        return b;
+    }
+
+    static size_t total(const Hook *h) { return h ? h->total : 0; }
+
+    static Node *toNode(const Hook *h) {
+        return static_cast<Node*>(const_cast<Hook*>(h));
+    }
+
+    static Hook *leftmost(Hook *h) {
+        while (h->left)
+            h = h->left;
+        return h;
+    }
+
+    static void finalize(Hook *h) {
+        h->total += total(h->left) + total(h->right);
+    }
+
+    uint32_t nextPriority() {
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        return seed_;
+    }
+
+    void replaceChild(Hook *parent, Hook *oldChild, Hook *newChild) {
+        if (!parent)
+            root_ = newChild;
+        else if (parent->left == oldChild)
+            parent->left = newChild;
+        else
+            parent->right = newChild;
+    }
+
+    void rotateUp(Hook *x) {
+        Hook *p = x->parent;
+        const size_t own = p->total - total(p->left) - total(p->right);
+
+        Hook *moved{};
+        if (p->left == x) {
+            moved = x->right;
+            p->left = moved;
+            x->right = p;
+        } else {
+            moved = x->left;
+            p->right = moved;
+            x->left = p;
+        }
+        if (moved)
+            moved->parent = p;
+
+        replaceChild(p->parent, p, x);
+        x->parent = p->parent;
+        p->parent = x;
+
+        x->total = p->total;
+        p->total = own + total(p->left) + total(p->right);
+    }
+
+#ifdef DEBUG
+    static void printSubtree(const Hook *h, size_t &start) {
+        if (!h) return;
+        printSubtree(h->left, start);
+        std::cout << start << "\n";
+        start += h->total - total(h->left) - total(h->right);
+        printSubtree(h->right, start);
+    }
+#endif
+
+    Hook *root_{};
+    uint32_t seed_{2463534242u};
+};
+
+// One row per block holding its exact start. Lookups are a binary search
+// without any walking, every edit shifts the rows behind it. That is cheap
+// while the rows fit in cache, i.e. for up to some ten thousand blocks.
+template <typename Node>
+class DenseIndex
+{
+    using NodeBase = Details::BlockListNodeBase;
+
+public:
+    struct Location {
+        size_t index{};
+        Node *node{};
+    };
+
+private:
+    struct CompareIndex {
+        bool operator()(const Location &row, size_t index) const {
+            return row.index < index;
+        }
+
+        bool operator()(size_t index, const Location &row) const {
+            return index < row.index;
+        }
+    };
+
+    using RowVector = std::vector<Location>;
+    using RowIt     = typename RowVector::iterator;
+
+public:
+    bool   empty() const { return rows_.empty(); }
+    size_t count() const { return rows_.size(); }
+
+    Location findClosest(size_t pos) const {
+        if (empty())
+            throw std::out_of_range("Index is empty");
+
+        const auto it = std::upper_bound(rows_.begin(), rows_.end(), pos, CompareIndex{});
+        return *(it - 1);
+    }
+
+    // First node for which before(node) is false, nullptr when there is none
+    template <typename Pred>
+    Location partitionPoint(Pred before, NodeBase *) const {
+        const auto rowBefore = [&before](const Location &row) {
+            return before(*row.node);
+        };
+        const auto it = std::partition_point(rows_.begin(), rows_.end(), rowBefore);
+        return it != rows_.end() ? *it : Location{};
+    }
+
+    void adjust(Node *, size_t nodeStart, std::ptrdiff_t delta) {
+        shift(std::upper_bound(rows_.begin(), rows_.end(), nodeStart, CompareIndex{}), delta);
+    }
+
+    // The node is already linked into the list right after 'after'
+    // (nullptr when it became the head)
+    void insertNode(Node *node, Node *after, size_t nodeStart) {
+        const RowIt at = after ? rowOf(after, nodeStart - after->count()) + 1 : rows_.begin();
+        shift(rows_.insert(at, {nodeStart, node}) + 1, node->count());
+    }
+
+    // Called while the node is still linked
+    void eraseNode(Node *node, size_t nodeStart) {
+        shift(rows_.erase(rowOf(node, nodeStart)), -std::ptrdiff_t(node->count()));
+    }
+
+    // [first, last] is linked right where it holds the items from 'start' on
+    void insertRange(Node *first, Node *last, size_t start, size_t items) {
+        RowVector added;
+        size_t index = start;
+        for (NodeBase *base = first; base != last->next; base = base->next) {
+            added.push_back({index, static_cast<Node*>(base)});
+            index += static_cast<Node*>(base)->count();
+        }
+
+        RowIt at = rows_.begin();
+        if (start > 0) {
+            Node *prev = static_cast<Node*>(first->prev);
+            at = rowOf(prev, start - prev->count()) + 1;
+        }
+        at = rows_.insert(at, added.begin(), added.end());
+        shift(at + added.size(), items);
+    }
+
+    // Called while [first, last] is still linked
+    void eraseRange(Node *first, Node *last, size_t start, size_t items) {
+        const RowIt from = rowOf(first, start);
+        RowIt to = from;
+        for (NodeBase *base = first; base != last->next; base = base->next)
+            ++to;
+        shift(rows_.erase(from, to), -std::ptrdiff_t(items));
+    }
+
+    // Moves the rows from 'first' on to dst
+    void splitOff(DenseIndex &dst, Node *first, size_t start) {
+        const RowIt from = rowOf(first, start);
+        dst.rows_.clear();
+        for (RowIt it = from; it != rows_.end(); ++it)
+            dst.rows_.push_back({it->index - start, it->node});
+        rows_.erase(from, rows_.end());
+    }
+
+    // Takes over the rows of a chain linked behind the last 'offset' items
+    void append(DenseIndex &other, size_t offset) {
+        for (const Location &row : other.rows_)
+            rows_.push_back({row.index + offset, row.node});
+        other.clear();
+    }
+
+    void maintain(NodeBase *, size_t) {}
+
+    void rebuild(NodeBase *sent, size_t) {
+        rows_.clear();
+        size_t index{};
+        for (NodeBase *base = sent->next; base != sent; base = base->next) {
+            rows_.push_back({index, static_cast<Node*>(base)});
+            index += static_cast<Node*>(base)->count();
+        }
+    }
+
+    void clear() {
+        rows_.clear();
+    }
+
+#ifdef DEBUG
+    void printTableIndexes() const {
+        for (const Location &row : rows_)
+            std::cout << row.index << "\n";
+    }
+#endif
+
+private:
+    // Empty blocks share their start with the next one, so look for the node
+    RowIt rowOf(const Node *node, size_t nodeStart) {
+        RowIt it = std::lower_bound(rows_.begin(), rows_.end(), nodeStart, CompareIndex{});
+        while (it->node != node)
+            ++it;
+        return it;
+    }
+
+    void shift(RowIt from, std::ptrdiff_t delta) {
+        for (; from != rows_.end(); ++from)
+            from->index += delta;
+    }
+
+    RowVector rows_{};
+};
+
+// Keeps nothing: lookups walk from the head, or from the finger on top.
+// For append and scan workloads that never look items up by position far
+// from the last one.
+template <typename Node>
+class NoIndex
+{
+    using NodeBase = Details::BlockListNodeBase;
+
+public:
+    // A null node stands for the head of the list
+    struct Location {
+        size_t index{};
+        Node *node{};
+    };
+
+    Location findClosest(size_t) const { return {}; }
+
+    template <typename Pred>
+    Location partitionPoint(Pred before, NodeBase *sent) const {
+        size_t index{};
+        NodeBase *base = sent->next;
+        while (base != sent && before(*static_cast<Node*>(base))) {
+            index += static_cast<Node*>(base)->count();
+            base = base->next;
+        }
+        return {index, base != sent ? static_cast<Node*>(base) : nullptr};
+    }
+
+    void adjust(Node *, size_t, std::ptrdiff_t) {}
+    void insertNode(Node *, Node *, size_t) {}
+    void eraseNode(Node *, size_t) {}
+    void insertRange(Node *, Node *, size_t, size_t) {}
+    void eraseRange(Node *, Node *, size_t, size_t) {}
+    void splitOff(NoIndex &, Node *, size_t) {}
+    void append(NoIndex &, size_t) {}
+    void maintain(NodeBase *, size_t) {}
+    void rebuild(NodeBase *, size_t) {}
+    void clear() {}
+
+#ifdef DEBUG
+    void printTableIndexes() const {}
+#endif
+};
+
+// Remembers the last resolved block on top of an index. The finger is kept
+// up to date by the same hooks as the index rows, and lookups close to it
+// start walking from there instead of asking the index. Only non-const
+// lookups move the finger, const ones just read it.
+template <typename Index, typename Node>
+class FingerIndex : public Index
+{
+    using NodeBase = BlockListNodeBase;
+
+public:
+    struct Location {
+        size_t index{};
+        Node *node{};
+        bool indexed{};   // found by the index rather than the finger
+    };
+
+    // Positions this far from the finger count as close
+    static constexpr size_t NEAR_ITEMS = 4 * size_t(Node::SIZE);
+
+    FingerIndex() = default;
+    FingerIndex(FingerIndex &&other) noexcept
+        : Index(std::move(other)), finger_(std::exchange(other.finger_, Location{})) {}
+
+    FingerIndex &operator=(FingerIndex &&other) noexcept {
+        Index::operator=(std::move(other));
+        finger_ = std::exchange(other.finger_, Location{});
+        return *this;
+    }
+
+    // The result may lie after 'pos', callers walk in both directions
+    Location findClosest(size_t pos) const {
+        if (finger_.node) {
+            const size_t distance = pos < finger_.index ? finger_.index - pos : pos - finger_.index;
+            if (distance <= NEAR_ITEMS)
+                return finger_;
+        }
+
+        return findIndexed(pos);
+    }
+
+    // Asks the index only and ignores the finger
+    Location findIndexed(size_t pos) const {
+        const auto &found = Index::findClosest(pos);
+        return {found.index, found.node, true};
+    }
+
+    template <typename Pred>
+    Location partitionPoint(Pred before, NodeBase *sent) const {
+        const auto found = Index::partitionPoint(before, sent);
+        return {found.index, found.node};
+    }
+
+    void setFinger(Node *node, size_t nodeStart) {
+        finger_ = {nodeStart, node};
+    }
+
+    void adjust(Node *node, size_t nodeStart, std::ptrdiff_t delta) {
+        Index::adjust(node, nodeStart, delta);
+        if (finger_.node && finger_.index > nodeStart)
+            finger_.index += delta;
+    }
+
+    void insertNode(Node *node, Node *after, size_t nodeStart) {
+        Index::insertNode(node, after, nodeStart);
+        if (finger_.node && finger_.index >= nodeStart)
+            finger_.index += node->count();
+    }
+
+    void eraseNode(Node *node, size_t nodeStart) {
+        Index::eraseNode(node, nodeStart);
+        if (finger_.node == node)
+            finger_ = {};
+        else if (finger_.node && finger_.index > nodeStart)
+            finger_.index -= node->count();
+    }
+
+    void insertRange(Node *first, Node *last, size_t start, size_t items) {
+        Index::insertRange(first, last, start, items);
+        if (finger_.node && finger_.index >= start)
+            finger_.index += items;
+    }
+
+    void eraseRange(Node *first, Node *last, size_t start, size_t items) {
+        Index::eraseRange(first, last, start, items);
+        if (finger_.node && finger_.index >= start + items)
+            finger_.index -= items;
+        else if (finger_.node && finger_.index >= start)
+            finger_ = {};
+    }
+
+    void splitOff(FingerIndex &dst, Node *first, size_t start) {
+        Index::splitOff(dst, first, start);
+        dst.finger_ = {};
+        if (finger_.node && finger_.index >= start)
+            finger_ = {};
+    }
+
+    void append(FingerIndex &other, size_t offset) {
+        Index::append(other, offset);
+        other.finger_ = {};
+    }
+
+    void rebuild(NodeBase *sent, size_t total) {
+        Index::rebuild(sent, total);
+        finger_ = {};
+    }
+
+    void clear() {
+        Index::clear();
+        finger_ = {};
+    }
+
+private:
+    Location finger_{};
+};
+
+// Hands out nodes from chunks taken from a memory resource. Chunks grow
+// geometrically up to CHUNK_BYTES, freed nodes go to an intrusive free list
+// and are all returned to the resource at once by release(). Once nodes
+// move to another list, both pools share the chunks and the last one frees
+// them.
+template <typename Node>
+class NodePool
+{
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+    static constexpr size_t MAX_CHUNK_NODES = std::max<size_t>(CHUNK_BYTES / sizeof(Node), 1);
+
+    struct Chunk {
+        Chunk *next{};
+        size_t bytes{};
+    };
+
+    struct FreeSlot {
+        FreeSlot *next{};
+    };
+
+    struct SharedChunks {
+        SharedChunks(std::pmr::memory_resource *resource, Chunk *chunks)
+            : resource(resource), chunks(chunks) {}
+        ~SharedChunks() { freeChunks(resource, chunks); }
+
+        std::pmr::memory_resource *resource;
+        Chunk *chunks;
+    };
+
+    static constexpr size_t HEADER_BYTES =
+        (sizeof(Chunk) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+    static constexpr size_t CHUNK_ALIGN = std::max(alignof(Node), alignof(Chunk));
+
+public:
+    explicit NodePool(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : resource_(resource) {}
+
+    NodePool(const NodePool &other) = delete;
+    NodePool(NodePool &&other) noexcept
+        : resource_(other.resource_),
+          chunks_(std::exchange(other.chunks_, nullptr)),
+          shared_(std::move(other.shared_)),
+          free_(std::exchange(other.free_, nullptr)),
+          cursor_(std::exchange(other.cursor_, nullptr)),
+          end_(std::exchange(other.end_, nullptr)),
+          nextChunkNodes_(std::exchange(other.nextChunkNodes_, 1)) {}
+
+    NodePool &operator=(const NodePool &other) = delete;
+    NodePool &operator=(NodePool &&other) noexcept {
+        if (this == &other) return *this;
+
+        release();
+        resource_ = other.resource_;
+        chunks_ = std::exchange(other.chunks_, nullptr);
+        shared_ = std::move(other.shared_);
+        free_ = std::exchange(other.free_, nullptr);
+        cursor_ = std::exchange(other.cursor_, nullptr);
+        end_ = std::exchange(other.end_, nullptr);
+        nextChunkNodes_ = std::exchange(other.nextChunkNodes_, 1);
+        return *this;
+    }
+
+    ~NodePool() { release(); }
+
+    std::pmr::memory_resource *resource() const { return resource_; }
+
+    // Makes the next 'nodes' allocations come from one chunk
+    void reserve(size_t nodes) {
+        if (size_t(end_ - cursor_) < nodes)
+            addChunk(nodes);
+    }
+
+    Node *create() {
+        return new (allocate()) Node;
+    }
+
+    void destroy(Node *node) {
+        node->~Node();
+        free_ = new (static_cast<void*>(node)) FreeSlot{free_};
+    }
+
+    // Keeps the chunks of 'other' alive as long as this pool, so nodes of
+    // either pool may be destroyed through the other one
+    bool share(NodePool &other) {
+        if (other.chunks_) {
+            Chunk *chunks = std::exchange(other.chunks_, nullptr);
+            other.shared_.push_back(std::make_shared<SharedChunks>(other.resource_, chunks));
+        }
+
+        for (const auto &chunks : other.shared_) {
+            if (std::find(shared_.begin(), shared_.end(), chunks) == shared_.end())
+                shared_.push_back(chunks);
+        }
+        return true;
+    }
+
+    // Every node handed out must already be destroyed or kept alive by a
+    // pool sharing the chunks
+    void release() {
+        freeChunks(resource_, chunks_);
+        chunks_ = nullptr;
+        shared_.clear();
+        free_ = nullptr;
+        cursor_ = end_ = nullptr;
+        nextChunkNodes_ = 1;
+    }
+
+private:
+    static void freeChunks(std::pmr::memory_resource *resource, Chunk *chunks) {
+        while (chunks) {
+            Chunk *next = chunks->next;
+            resource->deallocate(chunks, chunks->bytes, CHUNK_ALIGN);
+            chunks = next;
+        }
+    }
+
+    void *allocate() {
+        if (free_) {
+            void *slot = free_;
+            free_ = free_->next;
+            return slot;
+        }
+
+        if (cursor_ == end_)
+            addChunk(nextChunkNodes_);
+        return cursor_++;
+    }
+
+    void addChunk(size_t nodes) {
+        const size_t bytes = HEADER_BYTES + nodes * sizeof(Node);
+
+        void *memory = resource_->allocate(bytes, CHUNK_ALIGN);
+        chunks_ = new (memory) Chunk{chunks_, bytes};
+
+        cursor_ = reinterpret_cast<Node*>(static_cast<unsigned char*>(memory) + HEADER_BYTES);
+        end_ = cursor_ + nodes;
+        nextChunkNodes_ = std::min(std::max(nodes, nextChunkNodes_) * 2, MAX_CHUNK_NODES);
+    }
+
+    std::pmr::memory_resource *resource_;
+    Chunk *chunks_{};
+    std::vector<std::shared_ptr<SharedChunks>> shared_{};
+    FreeSlot *free_{};
+    Node *cursor_{};
+    Node *end_{};
+    size_t nextChunkNodes_{1};
+};
+
+// Allocates every node straight from the memory resource, suits arenas
+// such as std::pmr::monotonic_buffer_resource
+template <typename Node>
+class ResourceNodeAllocator
+{
+public:
+    explicit ResourceNodeAllocator(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : resource_(resource) {}
+
+    std::pmr::memory_resource *resource() const { return resource_; }
+
+    void reserve(size_t) {}
+
+    Node *create() {
+        void *memory = resource_->allocate(sizeof(Node), alignof(Node));
+        return new (memory) Node;
+    }
+
+    void destroy(Node *node) {
+        node->~Node();
+        resource_->deallocate(node, sizeof(Node), alignof(Node));
+    }
+
+    // Nodes may only change hands between equal resources
+    bool share(ResourceNodeAllocator &other) {
+        return resource_->is_equal(*other.resource_);
+    }
+
+    void release() {}
+
+private:
+    std::pmr::memory_resource *resource_;
+};
+
+// Layout of a file written by BlockList::save(): this header, the item
+// count of every block as uint16_t, padding up to 'itemsOffset' and then
+// the items of all blocks back to back
+struct BlockListFileHeader {
+    static constexpr char MAGIC[8] = {'B', 'L', 'K', 'L', 'I', 'S', 'T', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t ORDER_MARK = 0x01020304;
+    static constexpr size_t ITEMS_ALIGN = 64;
+
+    char     magic[8]{};
+    uint32_t version{};
+    uint32_t orderMark{};
+    uint32_t itemSize{};
+    uint32_t itemAlign{};
+    uint32_t blockCapacity{};
+    uint32_t reserved{};
+    uint64_t blockCount{};
+    uint64_t itemCount{};
+    uint64_t itemsOffset{};
+
+    template <typename T>
+    static BlockListFileHeader make(size_t blocks, size_t items, uint16_t capacity) {
+        BlockListFileHeader header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.orderMark = ORDER_MARK;
+        header.itemSize = sizeof(T);
+        header.itemAlign = alignof(T);
+        header.blockCapacity = capacity;
+        header.blockCount = blocks;
+        header.itemCount = items;
+
+        const size_t align = std::max(ITEMS_ALIGN, alignof(T));
+        const size_t countsEnd = sizeof(BlockListFileHeader) + blocks * sizeof(uint16_t);
+        header.itemsOffset = (countsEnd + align - 1) / align * align;
+        return header;
+    }
+
+    // Throws unless the file was written for items like T on this platform
+    template <typename T>
+    void check() const {
+        if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION)
+            throw std::runtime_error("Not a BlockList file");
+        if (orderMark != ORDER_MARK || itemSize != sizeof(T) || itemAlign != alignof(T))
+            throw std::runtime_error("BlockList file holds other items");
+        if (itemsOffset < sizeof(BlockListFileHeader) || itemsOffset % alignof(T) != 0
+            || (itemsOffset - sizeof(BlockListFileHeader)) / sizeof(uint16_t) < blockCount)
+            throw std::runtime_error("Corrupt BlockList file");
+
+        // Every saved block holds between one item and a full block
+        if (blockCapacity == 0 || blockCapacity > UINT16_MAX || blockCount > itemCount
+            || (itemCount > 0 && (itemCount - 1) / blockCapacity >= blockCount))
+            throw std::runtime_error("Corrupt BlockList file");
+    }
+
+    // Throws unless 'size' bytes are enough for what the header promises
+    void checkSize(uint64_t size) const {
+        if (itemsOffset > size || itemCount > (size - itemsOffset) / itemSize)
+            throw std::runtime_error("Corrupt BlockList file");
+    }
+
+    // Throws unless the block counts add up to the items of the file
+    void checkCounts(const uint16_t *counts) const {
+        uint64_t items{};
+        for (size_t i = 0; i < blockCount; ++i) {
+            if (counts[i] == 0 || counts[i] > blockCapacity)
+                throw std::runtime_error("Corrupt BlockList file");
+            items += counts[i];
+        }
+        if (items != itemCount)
+            throw std::runtime_error("Corrupt BlockList file");
+    }
+};
+
+}
+
+// Index strategies, picked per workload as the second BlockList argument:
+// Sparse keeps a few rows and walks between them, Counted is a treap with
+// O(log n) everything, Dense keeps an exact row per block and None relies
+// on walking from the head or the last resolved block.
+namespace BlockListIndex {
+
+struct Sparse {
+    static constexpr uint16_t TABLE_CAP = 7;
+
+    using Hook = Details::EmptyIndexHook;
+
+    template <typename Node>
+    using Index = Details::IndexTable<Node, TABLE_CAP>;
+};
+
+struct Counted {
+    using Hook = Details::CountedIndexHook;
+
+    template <typename Node>
+    using Index = Details::CountedIndex<Node>;
+};
+
+struct Dense {
+    using Hook = Details::EmptyIndexHook;
+
+    template <typename Node>
+    using Index = Details::DenseIndex<Node>;
+};
+
+struct None {
+    using Hook = Details::EmptyIndexHook;
+
+    template <typename Node>
+    using Index = Details::NoIndex<Node>;
+};
+
+}
+
+namespace BlockListAlloc {
+
+struct Pool {
+    template <typename Node>
+    using Allocator = Details::NodePool<Node>;
+};
+
+struct Resource {
+    template <typename Node>
+    using Allocator = Details::ResourceNodeAllocator<Node>;
+};
+
+}
+
+namespace Details {
+struct BlockListParallel;
+}
+
+// Snapshot of the operation counters of a BlockList. With
+// BlockListCounting::None only nodes and fillFactor are filled in.
+struct BlockListStats {
+    static constexpr size_t HOP_BUCKETS = 8;
+
+    size_t findNodeCalls{};
+    size_t findNodeHops{};
+    // Bucket 0 counts lookups that walked no block, bucket i > 0 those that
+    // walked [2^(i-1), 2^i) blocks, the last bucket is open-ended
+    size_t hopHistogram[HOP_BUCKETS]{};
+    // Lookups the finger could not serve, so findNodeCalls - findClosestCalls
+    // were served by walking from the last resolved block
+    size_t findClosestCalls{};
+
+    size_t indexRebuilds{};
+    std::chrono::nanoseconds rebuildTime{};
+    std::chrono::nanoseconds maintainTime{};
+
+    size_t nodeAllocs{};
+    size_t nodeFrees{};
+
+    size_t nodes{};
+    double fillFactor{};   // items / (nodes * block capacity)
+};
+
+namespace Details {
+
+// Counts nothing and takes no room in a BlockList
+struct NoCounters {
+    static constexpr bool ENABLED = false;
+
+    void countLookup(size_t, bool) const {}
+    void countRebuild(std::chrono::steady_clock::duration) const {}
+    void countMaintain(std::chrono::steady_clock::duration) const {}
+    void countAlloc() const {}
+    void countFree() const {}
+
+    BlockListStats snapshot() const { return {}; }
+    void reset() {}
+};
+
+// The counters behind BlockListStats. They are relaxed atomics, so const
+// lookups from several threads count without racing.
+struct AtomicCounters {
+    static constexpr bool ENABLED = true;
+
+    void countLookup(size_t hops, bool indexed) const {
+        add(findNodeCalls);
+        add(findClosestCalls, indexed);
+        add(findNodeHops, hops);
+
+        size_t bucket{};
+        while (hops && bucket + 1 < BlockListStats::HOP_BUCKETS) {
+            hops >>= 1;
+            ++bucket;
+        }
+        add(hopHistogram[bucket]);
+    }
+
+    void countRebuild(std::chrono::steady_clock::duration time) const {
+        add(indexRebuilds);
+        add(rebuildNanos, std::chrono::nanoseconds(time).count());
+    }
+
+    void countMaintain(std::chrono::steady_clock::duration time) const {
+        add(maintainNanos, std::chrono::nanoseconds(time).count());
+    }
+
+    void countAlloc() const { add(nodeAllocs); }
+    void countFree() const  { add(nodeFrees); }
+
+    BlockListStats snapshot() const {
+        const auto load = [](const auto &counter) { return counter.load(std::memory_order_relaxed); };
+
+        BlockListStats result{};
+        result.findNodeCalls = load(findNodeCalls);
+        result.findNodeHops = load(findNodeHops);
+        for (size_t i = 0; i < BlockListStats::HOP_BUCKETS; ++i)
+            result.hopHistogram[i] = load(hopHistogram[i]);
+        result.findClosestCalls = load(findClosestCalls);
+        result.indexRebuilds = load(indexRebuilds);
+        result.rebuildTime = std::chrono::nanoseconds(load(rebuildNanos));
+        result.maintainTime = std::chrono::nanoseconds(load(maintainNanos));
+        result.nodeAllocs = load(nodeAllocs);
+        result.nodeFrees = load(nodeFrees);
+        return result;
+    }
+
+    void reset() {
+        const auto zero = [](auto &counter) { counter.store(0, std::memory_order_relaxed); };
+
+        zero(findNodeCalls);
+        zero(findNodeHops);
+        for (Counter &bucket : hopHistogram)
+            zero(bucket);
+        zero(findClosestCalls);
+        zero(indexRebuilds);
+        zero(rebuildNanos);
+        zero(maintainNanos);
+        zero(nodeAllocs);
+        zero(nodeFrees);
+    }
+
+private:
+    using Counter = std::atomic<size_t>;
+
+    template <typename Atomic, typename N>
+    static void add(Atomic &counter, N n) {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static void add(Counter &counter) {
+        add(counter, size_t{1});
+    }
+
+    mutable Counter findNodeCalls{};
+    mutable Counter findNodeHops{};
+    mutable Counter hopHistogram[BlockListStats::HOP_BUCKETS]{};
+    mutable Counter findClosestCalls{};
+    mutable Counter indexRebuilds{};
+    mutable std::atomic<int64_t> rebuildNanos{};
+    mutable std::atomic<int64_t> maintainNanos{};
+    mutable Counter nodeAllocs{};
+    mutable Counter nodeFrees{};
+};
+
+}
+
+// Whether a BlockList collects the counters reported by stats(). The
+// choice is part of the type, so lists with and without counters can be
+// mixed freely.
+namespace BlockListCounting {
+
+struct None {
+    using Counters = Details::NoCounters;
+};
+
+struct Atomic {
+    using Counters = Details::AtomicCounters;
+};
+
+}
+
+template <typename T,
+          typename IndexPolicy = BlockListIndex::Counted,
+          uint16_t CAPACITY = Details::defaultBlockCapacity<T>(),
+          typename AllocPolicy = BlockListAlloc::Pool,
+          typename CountingPolicy = BlockListCounting::None>
+class BlockList
+{
+    using NodeBase   = Details::BlockListNodeBase;
+    using Node       = Details::BlockListNode<T, typename IndexPolicy::Hook, CAPACITY>;
+
+    using IndexTable    = Details::FingerIndex<typename IndexPolicy::template Index<Node>, Node>;
+    using NodeAllocator = typename AllocPolicy::template Allocator<Node>;
+    using Counters      = typename CountingPolicy::Counters;
+
+    // Nodes below this fill are merged with or topped up from a neighbour
+    static constexpr size_t MIN_FILL = CAPACITY / 4;
+
+    // A full block is split into two non-empty halves
+    static_assert(CAPACITY >= 2, "BlockList blocks must hold at least two items");
+
+    template <typename, typename, uint16_t>
+    friend class ConcurrentBlockList;
+    friend struct Details::BlockListParallel;
+
+public:
+    static constexpr uint16_t BLOCK_CAPACITY = CAPACITY;
+
+    using value_type = T;
+
+    // Iterators hold (node, offset) plus the absolute position. Like
+    // std::deque iterators they are invalidated by any insert or erase.
+    class ConstIterator
+    {
+        friend class BlockList;
+
+    public:
+        using value_type = T;
+        using reference = const T&;
+        using pointer = const T*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::random_access_iterator_tag;
+
+        ConstIterator() = default;
+
+        const T &operator*() const  { return item(); }
+        const T *operator->() const { return &item(); }
+
+        const T &operator[](difference_type k) const {
+            ConstIterator tmp = *this;
+            tmp.advance(k);
+            return tmp.item();
+        }
+
+        //prefix
+        ConstIterator &operator++() {
+            increment();
+            return *this;
+        }
+
+        //postfix
+        ConstIterator operator++(int) {
+            auto tmp = *this;
+            increment();
+            return tmp;
+        }
+
+        //prefix
+        ConstIterator &operator--() {
+            decrement();
+            return *this;
+        }
+
+        //postfix
+        ConstIterator operator--(int) {
+            auto tmp = *this;
+            decrement();
+            return tmp;
+        }
+
+        ConstIterator &operator+=(difference_type k) {
+            advance(k);
+            return *this;
+        }
+
+        ConstIterator &operator-=(difference_type k) {
+            advance(-k);
+            return *this;
+        }
+
+        ConstIterator operator+(difference_type k) const {
+            auto tmp = *this;
+            tmp.advance(k);
+            return tmp;
+        }
+
+        friend ConstIterator operator+(difference_type k, const ConstIterator &it) {
+            return it + k;
+        }
+
+        ConstIterator operator-(difference_type k) const {
+            auto tmp = *this;
+            tmp.advance(-k);
+            return tmp;
+        }
+
+        difference_type operator-(const ConstIterator &other) const {
+            return difference_type(pos_) - difference_type(other.pos_);
+        }
+
+        bool operator==(const ConstIterator &other) const { return pos_ == other.pos_; }
+        bool operator!=(const ConstIterator &other) const { return pos_ != other.pos_; }
+        bool operator<(const ConstIterator &other)  const { return pos_ < other.pos_; }
+        bool operator>(const ConstIterator &other)  const { return pos_ > other.pos_; }
+        bool operator<=(const ConstIterator &other) const { return pos_ <= other.pos_; }
+        bool operator>=(const ConstIterator &other) const { return pos_ >= other.pos_; }
+
+        size_t index() const { return pos_; }
+
+    protected:
+        // Targets further than this are located through the index instead
+        // of walking block by block
+        static constexpr size_t NEAR_ITEMS = 4 * size_t(CAPACITY);
+
+        ConstIterator(const BlockList *list, NodeBase *node, size_t offset, size_t pos)
+            : list_(list), node_(node), offset_(offset), pos_(pos) {}
+
+        T &item() const {
+            return (*static_cast<Node*>(node_))[offset_];
+        }
+
+        void increment() {
+            if (++offset_ == static_cast<Node*>(node_)->count()) {
+                node_ = node_->next;
+                offset_ = 0;
+            }
+            ++pos_;
+        }
+
+        void decrement() {
+            if (offset_ == 0) {
+                node_ = node_->prev;
+                offset_ = static_cast<Node*>(node_)->count();
+            }
+            --offset_;
+            --pos_;
+        }
+
+        void advance(difference_type k) {
+            const size_t target = pos_ + k;
+            if (target == list_->size_) {
+                node_ = list_->sent_;
+                offset_ = 0;
+                pos_ = target;
+                return;
+            }
+
+            size_t nodeStart = pos_ - offset_;
+            const size_t distance = k < 0 ? size_t(-k) : size_t(k);
+            if (distance > NEAR_ITEMS) {
+                node_ = list_->findNode(target, nodeStart);
+            } else if (k > 0) {
+                while (nodeStart + static_cast<Node*>(node_)->count() <= target) {
+                    nodeStart += static_cast<Node*>(node_)->count();
+                    node_ = node_->next;
+                }
+            } else {
+                while (target < nodeStart) {
+                    node_ = node_->prev;
+                    nodeStart -= static_cast<Node*>(node_)->count();
+                }
+            }
+
+            offset_ = target - nodeStart;
+            pos_ = target;
+        }
+
+        const BlockList *list_{};
+        NodeBase *node_{};
+        size_t offset_{};
+        size_t pos_{};
+    };
+
+    class Iterator : public ConstIterator
+    {
+        friend class BlockList;
+
+        using ConstIterator::item;
+
+    public:
+        using reference = T&;
+        using pointer = T*;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() : ConstIterator() {}
+
+        T &operator*() const  { return item(); }
+        T *operator->() const { return &item(); }
+
+        T &operator[](difference_type k) const {
+            Iterator tmp = *this;
+            tmp.advance(k);
+            return tmp.item();
+        }
+
+        //prefix
+        Iterator &operator++() {
+            this->increment();
+            return *this;
+        }
+
+        //postfix
+        Iterator operator++(int) {
+            auto tmp = *this;
+            this->increment();
+            return tmp;
+        }
+
+        //prefix
+        Iterator &operator--() {
+            this->decrement();
+            return *this;
+        }
+
+        //postfix
+        Iterator operator--(int) {
+            auto tmp = *this;
+            this->decrement();
+            return tmp;
+        }
+
+        Iterator &operator+=(difference_type k) {
+            this->advance(k);
+            return *this;
+        }
+
+        Iterator &operator-=(difference_type k) {
+            this->advance(-k);
+            return *this;
+        }
+
+        Iterator operator+(difference_type k) const {
+            auto tmp = *this;
+            tmp.advance(k);
+            return tmp;
+        }
+
+        friend Iterator operator+(difference_type k, const Iterator &it) {
+            return it + k;
+        }
+
+        using ConstIterator::operator-;
+
+        Iterator operator-(difference_type k) const {
+            auto tmp = *this;
+            tmp.advance(-k);
+            return tmp;
+        }
+
+    private:
+        Iterator(const BlockList *list, NodeBase *node, size_t offset, size_t pos)
+            : ConstIterator(list, node, offset, pos) {}
+    };
+
+    BlockList()
+        : size_(0), sent_(new NodeBase) {}
+
+    explicit BlockList(std::pmr::memory_resource *resource)
+        : size_(0), sent_(new NodeBase), alloc_(resource) {}
+
+    BlockList(const BlockList &other)
+        : size_(0), sent_(new NodeBase)
+    {
+        copyNodes(other);
+    }
+
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    BlockList(InputIt first, InputIt last,
+              std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : size_(0), sent_(new NodeBase), alloc_(resource)
+    {
+        assign(first, last);
+    }
+
+    BlockList(BlockList &&other) noexcept
+        : size_(other.size_), sent_(other.sent_), table_(std::move(other.table_)),
+          alloc_(std::move(other.alloc_))
+    {
+        other.sent_ = new NodeBase;
+        other.size_ = 0;
+    }
+
+    BlockList(const std::initializer_list<T> &initList)
+        : size_(0), sent_(new NodeBase)
+    {
+        assign(initList.begin(), initList.end());
+    }
+
+    ~BlockList() {
+        clear();
+        delete sent_;
+    }
+
+    const T &operator[](size_t pos) const {
+        if (pos >= size_)
+            throw std::out_of_range("Index out of bounds");
+
+        size_t nodeStart{};
+        Node *node = findNode(pos, nodeStart);
+        return node->at(pos - nodeStart);
+    }
+
+    T &operator[](size_t pos) {
+        if (pos >= size_)
+            throw std::out_of_range("Index out of bounds");
+
+        size_t nodeStart{};
+        Node *node = findNode(pos, nodeStart);
+        return node->at(pos - nodeStart);
+    }
+
+    BlockList &operator=(const BlockList &other) {
+        if (this == &other) return *this;
+
+        clear();
+        copyNodes(other);
+
+        return *this;
+    }
+
+    BlockList &operator=(BlockList &&other) noexcept {
+        if (this == &other) return *this;
+
+        clear();
+        delete sent_;
+
+        size_ = other.size_;
+        sent_ = other.sent_;
+        table_ = std::move(other.table_);
+        alloc_ = std::move(other.alloc_);
+        other.sent_ = new NodeBase;
+        other.size_ = 0;
+        other.table_.clear();
+
+        return *this;
+    }
+
+    BlockList &operator=(const std::initializer_list<T> &initList) {
+        assign(initList.begin(), initList.end());
+
+        return *this;
+    }
+
+    // Packs the range into full blocks and builds the index once
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        clear();
+
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>)
+            alloc_.reserve(nodesFor(std::distance(first, last)));
+
+        size_ += appendPacked(sent_, first, last);
+        rebuildIndexTable();
+    }
 
-        Node *next = static_cast<Node *>(curr->next);
-        if (!next->filled() && next != sent_) {
-            next->pushFront(std::move_if_noexcept(lastItem));
-            //table_.incrementAfter(pos);
-        } else {
-            Node *add = new Node;
-            add->pushBack(std::move_if_noexcept(lastItem));
+    T &at(size_t i)             { return operator[](i); }
+    const T &at(size_t i) const { return operator[](i); }
+
+    ConstIterator begin()  const { return ConstIterator(this, sent_->next, 0, 0); }
+    Iterator      begin()        { return Iterator(this, sent_->next, 0, 0); }
+
+    ConstIterator end()    const { return ConstIterator(this, sent_, 0, size_); }
+    Iterator      end()          { return Iterator(this, sent_, 0, size_); }
+
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend()   const { return end(); }
+
+    size_t size()  const { return size_; }
+    bool   empty() const { return sent_->next == sent_; }
+
+    std::pmr::memory_resource *resource() const { return alloc_.resource(); }
+
+    // Counts the blocks by walking the chain, which takes time linear in
+    // their number. The counters are read without stopping other threads.
+    BlockListStats stats() const {
+        BlockListStats result = stats_.snapshot();
+
+        for (const NodeBase *base = sent_->next; base != sent_; base = base->next)
+            ++result.nodes;
+        if (result.nodes)
+            result.fillFactor = double(size_) / (result.nodes * CAPACITY);
+        return result;
+    }
+
+    void resetStats() {
+        stats_.reset();
+    }
+
+    template <typename U>
+    void insertFront(U &&item) {
+        emplaceFront(std::forward<U>(item));
+    }
+
+    template <typename U>
+    void insertBack(U &&item) {
+        emplaceBack(std::forward<U>(item));
+    }
+
+    template <typename U>
+    void insert(size_t pos, U &&item) {
+        emplace(pos, std::forward<U>(item));
+    }
+
+    template <typename U>
+    Iterator insert(ConstIterator it, U &&item) {
+        return emplace(it, std::forward<U>(item));
+    }
+
+    // The emplace functions construct the item from args right in its slot
+    template <typename... Args>
+    T &emplaceFront(Args &&...args) {
+        Node *head = static_cast<Node *>(sent_->next);
+        if (!empty() && !head->filled()) {
+            T &item = head->emplace(0, std::forward<Args>(args)...);
+            ++size_;
+            adjustIndex(head, 0, 1);
+            return item;
+        }
+
+        Node *add = createNode();
+        T &item = emplaceInto(add, std::forward<Args>(args)...);
+        ++size_;
+        linkNode(sent_, add, head, 0);
+        return item;
+    }
+
+    template <typename... Args>
+    T &emplaceBack(Args &&...args) {
+        Node *tail = static_cast<Node *>(sent_->prev);
+        if (!empty() && !tail->filled()) {
+            T &item = tail->emplace(tail->count(), std::forward<Args>(args)...);
+            ++size_;
+            adjustIndex(tail, size_ - tail->count(), 1);
+            return item;
+        }
+
+        Node *add = createNode();
+        T &item = emplaceInto(add, std::forward<Args>(args)...);
+        ++size_;
+        linkNode(tail, add, sent_, size_ - 1);
+        return item;
+    }
+
+    template <typename... Args>
+    T &emplace(size_t pos, Args &&...args) {
+        if (pos > size_)
+            throw std::out_of_range("Index out of bounds");
+
+        if (pos == 0)
+            return emplaceFront(std::forward<Args>(args)...);
+        if (pos == size_)
+            return emplaceBack(std::forward<Args>(args)...);
+
+        size_t nodeStart{};
+        Node *curr = findNode(pos, nodeStart);
+        return *emplaceAt(curr, nodeStart, pos - nodeStart, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    Iterator emplace(ConstIterator it, Args &&...args) {
+        if (it.node_ == sent_) {
+            emplaceBack(std::forward<Args>(args)...);
+            Node *tail = static_cast<Node*>(sent_->prev);
+            return Iterator(this, tail, tail->count() - 1, size_ - 1);
+        }
+
+        Node *curr = static_cast<Node*>(it.node_);
+        return emplaceAt(curr, it.pos_ - it.offset_, it.offset_, std::forward<Args>(args)...);
+    }
 
-            insertNodeBetween(curr, add, curr->next);
+    // Packs the range into new blocks and splices them in at once
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert(size_t pos, InputIt first, InputIt last) {
+        if (pos > size_)
+            throw std::out_of_range("Index out of bounds");
 
-            table_.incrementAfter(pos);
+        if (pos == size_) {
+            insertRange(sent_, size_, 0, first, last);
+            return;
         }
+
+        size_t nodeStart{};
+        Node *node = findNode(pos, nodeStart);
+        insertRange(node, nodeStart, pos - nodeStart, first, last);
+    }
+
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    Iterator insert(ConstIterator it, InputIt first, InputIt last) {
+        insertRange(it.node_, it.pos_ - it.offset_, it.offset_, first, last);
+        return iteratorAt(it.pos_);
     }
 
     void erase(size_t pos) {
         if (pos >= size_)
             throw std::out_of_range("Index out of bounds");
 
-        size_t elPos{};
-        Node *node = findNode(pos, elPos);
-        node->erase(elPos);
-        if (node->empty()) {
-            node->prev->next = node->next;
-            node->next->prev = node->prev;
+        size_t nodeStart{};
+        Node *node = findNode(pos, nodeStart);
+        eraseAt(node, nodeStart, pos - nodeStart);
+    }
 
-            delete node;
+    Iterator erase(ConstIterator it) {
+        if (it.node_ == sent_)
+            throw std::out_of_range("Iterator out of bounds");
 
-            if (table_.containsNode(node))
-                rebuildIndexTable();
+        Node *node = static_cast<Node*>(it.node_);
+        return eraseAt(node, it.pos_ - it.offset_, it.offset_);
+    }
+
+    // Frees the blocks inside the range as a whole and trims the two at its ends
+    Iterator erase(ConstIterator first, ConstIterator last) {
+        if (first.pos_ > last.pos_ || last.pos_ > size_)
+            throw std::out_of_range("Iterator out of bounds");
+
+        const size_t pos = first.pos_;
+        if (first == last)
+            return iteratorAt(pos);
+
+        const size_t count = last.pos_ - pos;
+        Node *head = static_cast<Node*>(first.node_);
+        const size_t headStart = pos - first.offset_;
+
+        if (first.node_ == last.node_) {
+            head->erase(first.offset_, last.offset_);
+            table_.adjust(head, headStart, -std::ptrdiff_t(count));
+            size_ -= count;
+
+            if (head->count() < MIN_FILL)
+                rebalance(head, headStart);
         } else {
-            table_.decrementAfter(pos);
+            NodeBase *drop = head;
+            if (first.offset_ > 0) {
+                const size_t cut = head->count() - first.offset_;
+                head->erase(first.offset_, head->count());
+                table_.adjust(head, headStart, -std::ptrdiff_t(cut));
+                drop = head->next;
+            }
+            if (drop != last.node_)
+                dropNodes(drop, last.node_->prev, pos);
+
+            Node *tail = last.node_ != sent_ ? static_cast<Node*>(last.node_) : nullptr;
+            if (tail && last.offset_ > 0) {
+                tail->erase(0, last.offset_);
+                table_.adjust(tail, pos, -std::ptrdiff_t(last.offset_));
+            }
+            size_ -= count;
+
+            // Only the blocks at the seam can be underfull
+            if (tail && tail->count() < MIN_FILL)
+                rebalance(tail, pos);
+            if (first.offset_ > 0 && head->count() < MIN_FILL)
+                rebalance(head, headStart);
         }
-        --size_;
+
+        if (size_ == 0)
+            table_.clear();
+        maintainIndex();
+
+        return iteratorAt(pos);
+    }
+
+    // Sorted mode: the functions below expect the items to be ordered by
+    // comp. The index finds the block by its last item, then the block is
+    // searched on its own.
+    template <typename Key, typename Compare = std::less<>>
+    size_t lowerBound(const Key &key, Compare comp = Compare{}) const {
+        const Bound b = findBound([&](const T &item) { return comp(item, key); });
+        return b.nodeStart + b.offset;
+    }
+
+    template <typename Key, typename Compare = std::less<>>
+    size_t upperBound(const Key &key, Compare comp = Compare{}) const {
+        const Bound b = findBound([&](const T &item) { return !comp(key, item); });
+        return b.nodeStart + b.offset;
+    }
+
+    // Inserts after the items equal to 'item', returns its position
+    template <typename U, typename Compare = std::less<>>
+    size_t insertSorted(U &&item, Compare comp = Compare{}) {
+        const Bound b = findBound([&](const T &other) { return !comp(item, other); });
+        const size_t pos = b.nodeStart + b.offset;
+
+        if (b.node)
+            emplaceAt(b.node, b.nodeStart, b.offset, std::forward<U>(item));
+        else
+            emplaceBack(std::forward<U>(item));
+        return pos;
+    }
+
+    // Erases the items equal to 'key', returns how many there were
+    template <typename Key, typename Compare = std::less<>>
+    size_t eraseKey(const Key &key, Compare comp = Compare{}) {
+        const size_t first = lowerBound(key, comp);
+        const size_t last = upperBound(key, comp);
+        if (first != last)
+            erase(iteratorAt(first), iteratorAt(last));
+        return last - first;
+    }
+
+    // Moves [pos, size()) into a new list. The blocks behind 'pos' are
+    // relinked as they are and only the block holding 'pos' is cut.
+    BlockList splitAt(size_t pos) {
+        if (pos > size_)
+            throw std::out_of_range("Index out of bounds");
+
+        BlockList tail(resource());
+        if (pos == size_)
+            return tail;
+
+        tail.alloc_.share(alloc_);
+
+        size_t nodeStart{};
+        Node *node = findNode(pos, nodeStart);
+        const size_t offset = pos - nodeStart;
+
+        Node *rest{};
+        NodeBase *first = node;
+        if (offset > 0) {
+            const size_t moved = node->count() - offset;
+            rest = tail.createNode();
+            node->moveTailTo(*rest, offset);
+            table_.adjust(node, nodeStart, -std::ptrdiff_t(moved));
+            first = node->next;
+        }
+
+        if (first != sent_) {
+            table_.splitOff(tail.table_, static_cast<Node*>(first), pos);
+
+            NodeBase *last = sent_->prev;
+            first->prev->next = sent_;
+            sent_->prev = first->prev;
+            insertChainBetween(tail.sent_, first, last, tail.sent_);
+        }
+
+        tail.size_ = size_ - pos;
+        size_ = pos;
+
+        if (rest) {
+            tail.linkNode(tail.sent_, rest, tail.sent_->next, 0);
+            if (rest->count() < MIN_FILL)
+                tail.rebalance(rest, 0);
+            if (node->count() < MIN_FILL)
+                rebalance(node, nodeStart);
+        }
+
         if (size_ == 0)
             table_.clear();
+        maintainIndex();
+        tail.maintainIndex();
+
+        return tail;
+    }
+
+    // Relinks the blocks of 'other' behind the last one and merges the
+    // indexes. Lists on unequal memory resources move the items instead.
+    void append(BlockList &&other) {
+        if (this == &other || other.empty())
+            return;
+
+        if (!alloc_.share(other.alloc_)) {
+            insert(size_, std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            other.clear();
+            return;
+        }
+
+        const size_t offset = size_;
+        NodeBase *oldTail = sent_->prev;
+        const size_t oldTailStart = oldTail != sent_ ? offset - static_cast<Node*>(oldTail)->count() : 0;
+        Node *head = static_cast<Node*>(other.sent_->next);
+
+        insertChainBetween(oldTail, head, other.sent_->prev, sent_);
+        other.sent_->next = other.sent_;
+        other.sent_->prev = other.sent_;
+
+        table_.append(other.table_, offset);
+        size_ += std::exchange(other.size_, 0);
+        other.clear();
+
+        // Only the blocks at the seam can be underfull
+        if (head->count() < MIN_FILL)
+            rebalance(head, offset);
+        if (oldTail != sent_ && static_cast<Node*>(oldTail)->count() < MIN_FILL)
+            rebalance(static_cast<Node*>(oldTail), oldTailStart);
+
+        maintainIndex();
     }
 
     void clear() {
         auto current = static_cast<Node*>(sent_->next);
         while (current != sent_) {
             auto next = static_cast<Node*>(current->next);
-            delete current;
+            destroyNode(current);
             current = next;
         }
+        alloc_.release();
 
         sent_->next = sent_;
         sent_->prev = sent_;
@@ -507,41 +2479,198 @@ public:
         size_ = 0;
     }
 
+    // Writes the binary format of Details::BlockListFileHeader, the block
+    // layout is kept so load() gives back the same blocks
+    void save(std::ostream &os) const {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable items can be saved");
+
+        std::vector<uint16_t> counts;
+        for (NodeBase *base = sent_->next; base != sent_; base = base->next)
+            counts.push_back(static_cast<Node*>(base)->count());
+
+        const auto header = Details::BlockListFileHeader::make<T>(counts.size(), size_, CAPACITY);
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        os.write(reinterpret_cast<const char*>(counts.data()), counts.size() * sizeof(uint16_t));
+
+        const size_t written = sizeof(header) + counts.size() * sizeof(uint16_t);
+        const std::string padding(header.itemsOffset - written, '\0');
+        os.write(padding.data(), padding.size());
+
+        for (NodeBase *base = sent_->next; base != sent_; base = base->next) {
+            const Node *node = static_cast<const Node*>(base);
+            os.write(reinterpret_cast<const char*>(&(*node)[0]), node->count() * sizeof(T));
+        }
+
+        if (!os)
+            throw std::runtime_error("Failed to write BlockList");
+    }
+
+    void save(const std::string &path) const {
+        std::ofstream os(path, std::ios::binary);
+        if (!os)
+            throw std::runtime_error("Cannot open " + path);
+        save(os);
+    }
+
+    // Replaces the items with the ones saved by save(). The items are read
+    // straight into the blocks, which keep the saved layout when the block
+    // capacity matches and are packed full otherwise. A file whose header
+    // or block counts do not add up is rejected before the list changes,
+    // one that ends early leaves the list empty.
+    void load(std::istream &is) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable items can be loaded");
+
+        const std::streamoff length = bytesLeft(is);
+
+        Details::BlockListFileHeader header;
+        readBytes(is, &header, sizeof(header));
+        header.check<T>();
+        if (length >= 0)
+            header.checkSize(length);
+
+        // Read piecewise, so a header that claims more blocks than the stream
+        // holds fails before it costs much memory
+        constexpr size_t COUNTS_CHUNK = 1 << 16;
+        std::vector<uint16_t> counts;
+        while (counts.size() < header.blockCount) {
+            const size_t read = counts.size();
+            counts.resize(read + std::min<size_t>(header.blockCount - read, COUNTS_CHUNK));
+            readBytes(is, counts.data() + read, (counts.size() - read) * sizeof(uint16_t));
+        }
+        header.checkCounts(counts.data());
+        is.ignore(header.itemsOffset - sizeof(header) - counts.size() * sizeof(uint16_t));
+
+        clear();
+        try {
+            const bool sameLayout = header.blockCapacity == CAPACITY;
+            alloc_.reserve(sameLayout ? counts.size() : nodesFor(header.itemCount));
+
+            for (size_t left : counts) {
+                bool newBlock = sameLayout;
+                while (left > 0) {
+                    Node *tail = static_cast<Node*>(sent_->prev);
+                    if (newBlock || tail == sent_ || tail->filled()) {
+                        tail = createNode();
+                        insertNodeBetween(sent_->prev, tail, sent_);
+                        newBlock = false;
+                    }
+
+                    const size_t n = std::min<size_t>(left, CAPACITY - tail->count());
+                    tail->fillBack(n, [&is](void *bytes, size_t size) { readBytes(is, bytes, size); });
+                    size_ += n;
+                    left -= n;
+                }
+            }
+        } catch (...) {
+            clear();
+            throw;
+        }
+        rebuildIndexTable();
+    }
+
+    void load(const std::string &path) {
+        std::ifstream is(path, std::ios::binary);
+        if (!is)
+            throw std::runtime_error("Cannot open " + path);
+        load(is);
+    }
+
     void rebuildIndexTable() {
+        if constexpr (Counters::ENABLED) {
+            const auto start = std::chrono::steady_clock::now();
+            table_.rebuild(sent_, size_);
+            stats_.countRebuild(std::chrono::steady_clock::now() - start);
+        } else {
+            table_.rebuild(sent_, size_);
+        }
+    }
+
+    // Repacks the items into full blocks in place and frees the emptied nodes
+    void compact() {
         if (empty()) return;
-        table_.clear();
 
-        const size_t capacity = table_.capacity();
-        const size_t total = size_;
-        const size_t step = (total + capacity) / capacity;
+        Node *dst = static_cast<Node*>(sent_->next);
+        NodeBase *base = dst->next;
+        while (base != sent_) {
+            Node *src = static_cast<Node*>(base);
+            base = base->next;
+
+            src->moveHeadTo(*dst, std::min<size_t>(CAPACITY - dst->count(), src->count()));
+            if (src->empty()) {
+                src->prev->next = src->next;
+                src->next->prev = src->prev;
+                destroyNode(src);
+            } else {
+                dst = src;
+            }
+        }
+        rebuildIndexTable();
+    }
 
-        Node* node = static_cast<Node*>(sent_->next);
-        size_t nodeStart{};
-        size_t threshold{};
+    // Repacks the items into full blocks taken from a fresh allocator, so the
+    // memory of the old nodes is released and the new ones are contiguous.
+    // All new blocks are made before the first item moves, so running out of
+    // memory leaves the list as it was.
+    void shrinkToFit() {
+        NodeAllocator fresh(alloc_.resource());
+        const size_t nodes = nodesFor(size_);
+        fresh.reserve(nodes);
+
+        NodeBase chain;
+        try {
+            for (size_t i = 0; i < nodes; ++i) {
+                insertNodeBetween(chain.prev, fresh.create(), &chain);
+                stats_.countAlloc();
+            }
+        } catch (...) {
+            while (chain.next != &chain) {
+                Node *node = static_cast<Node*>(chain.next);
+                chain.next = node->next;
+                fresh.destroy(node);
+            }
+            throw;
+        }
 
-        while(table_.count() < capacity && threshold < total) {
-            while (node != sent_ && nodeStart + node->count() <= threshold) {
-                nodeStart += node->count();
-                node = static_cast<Node*>(node->next);
+        NodeBase *dst = chain.next;
+        for (NodeBase *base = sent_->next; base != sent_; base = base->next) {
+            Node *src = static_cast<Node*>(base);
+            while (!src->empty()) {
+                Node *into = static_cast<Node*>(dst);
+                if (into->filled()) {
+                    dst = dst->next;
+                    continue;
+                }
+                src->moveHeadTo(*into, std::min<size_t>(CAPACITY - into->count(), src->count()));
             }
-            if (node == sent_) break;
+        }
 
-            table_.insert(nodeStart, node);
+        NodeBase *base = sent_->next;
+        while (base != sent_) {
+            Node *node = static_cast<Node*>(base);
+            base = base->next;
+            destroyNode(node);
+        }
 
-            threshold += step;
+        if (nodes) {
+            insertChainBetween(sent_, chain.next, chain.prev, sent_);
+        } else {
+            sent_->next = sent_;
+            sent_->prev = sent_;
         }
+        alloc_ = std::move(fresh);
+        rebuildIndexTable();
     }
 
 #ifdef DEBUG
     void iteratingTest() const {
-        for (size_t i = 0; i < size_; ++i) {
-            at(i);
+        for (const T &el : *this) {
+            (void)el;
         }
     }
 
     void printAllElements() const {
-        for (size_t i = 0; i < size_; ++i) {
-            std::cout << at(i);
+        for (const T &el : *this) {
+            std::cout << el;
         }
     }
 
@@ -572,32 +2701,365 @@ private:
         before->next = node;
     }
 
-    template <typename U>
-    void initFirstNode(U &&item) {
-        Node *add = new Node;
-        add->pushFront(std::forward<U>(item));
+    void insertChainBetween(NodeBase *before, NodeBase *first, NodeBase *last, NodeBase *after) {
+        first->prev = before;
+        last->next = after;
+
+        after->prev = last;
+        before->next = first;
+    }
+
+    void linkNode(NodeBase *before, Node *node, NodeBase *after, size_t nodeStart) {
+        insertNodeBetween(before, node, after);
+        table_.insertNode(node, before == sent_ ? nullptr : static_cast<Node*>(before), nodeStart);
+        maintainIndex();
+    }
+
+    void adjustIndex(Node *node, size_t nodeStart, std::ptrdiff_t delta) {
+        table_.adjust(node, nodeStart, delta);
+        maintainIndex();
+    }
+
+    void maintainIndex() {
+        if constexpr (Counters::ENABLED) {
+            const auto start = std::chrono::steady_clock::now();
+            table_.maintain(sent_, size_);
+            stats_.countMaintain(std::chrono::steady_clock::now() - start);
+        } else {
+            table_.maintain(sent_, size_);
+        }
+    }
+
+    Node *createNode() {
+        stats_.countAlloc();
+        return alloc_.create();
+    }
+
+    void destroyNode(Node *node) {
+        stats_.countFree();
+        alloc_.destroy(node);
+    }
+
+    static size_t nodesFor(size_t items) {
+        return (items + CAPACITY - 1) / CAPACITY;
+    }
+
+    // Appends to the chain closed by 'chain' without touching the index,
+    // returns the number of items added
+    template <typename InputIt>
+    size_t appendPacked(NodeBase *chain, InputIt first, InputIt last) {
+        size_t added{};
+        NodeBase *tail = chain->prev;
+        while (first != last) {
+            Node *node{};
+            if (tail != chain && !static_cast<Node*>(tail)->filled()) {
+                node = static_cast<Node*>(tail);
+            } else {
+                node = createNode();
+                insertNodeBetween(tail, node, chain);
+                tail = node;
+            }
+
+            const size_t before = node->count();
+            first = node->pushBackRange(first, last);
+            added += node->count() - before;
+        }
+        return added;
+    }
+
+    template <typename InputIt>
+    void insertRange(NodeBase *node, size_t nodeStart, size_t offset, InputIt first, InputIt last) {
+        // Packed aside first, so the range may come from this list
+        NodeBase chain;
+        const size_t count = appendPacked(&chain, first, last);
+        if (count == 0)
+            return;
+
+        const size_t pos = nodeStart + offset;
+        NodeBase *before = node->prev;
+        size_t moved{};
+        if (offset > 0) {
+            // The tail of the split block goes behind the new items
+            Node *curr = static_cast<Node*>(node);
+            Node *rest = static_cast<Node*>(chain.prev);
+            moved = curr->count() - offset;
+            if (rest->count() + moved > CAPACITY) {
+                rest = createNode();
+                insertNodeBetween(chain.prev, rest, &chain);
+            }
+            curr->moveTailTo(*rest, offset);
+            table_.adjust(curr, nodeStart, -std::ptrdiff_t(moved));
+            before = curr;
+        }
+
+        Node *head = static_cast<Node*>(chain.next);
+        Node *tail = static_cast<Node*>(chain.prev);
+        insertChainBetween(before, head, tail, before->next);
+
+        size_ += count;
+        table_.insertRange(head, tail, pos, count + moved);
+
+        // Only the blocks at the seams can be underfull
+        const size_t beforeStart = before != sent_ ? pos - static_cast<Node*>(before)->count() : 0;
+        if (tail->count() < MIN_FILL)
+            rebalance(tail, pos + count + moved - tail->count());
+        if (before != sent_ && static_cast<Node*>(before)->count() < MIN_FILL)
+            rebalance(static_cast<Node*>(before), beforeStart);
+
+        maintainIndex();
+    }
+
+    // Unlinks and frees the whole blocks [first, last], which start at 'start'
+    void dropNodes(NodeBase *first, NodeBase *last, size_t start) {
+        size_t items{};
+        for (NodeBase *base = first; base != last->next; base = base->next)
+            items += static_cast<Node*>(base)->count();
+        table_.eraseRange(static_cast<Node*>(first), static_cast<Node*>(last), start, items);
+
+        NodeBase *after = last->next;
+        first->prev->next = after;
+        after->prev = first->prev;
+
+        while (first != after) {
+            Node *node = static_cast<Node*>(first);
+            first = first->next;
+            destroyNode(node);
+        }
+    }
+
+    void copyNodes(const BlockList &other) {
+        alloc_.reserve(nodesFor(other.size_));
+        for (NodeBase *base = other.sent_->next; base != other.sent_; base = base->next) {
+            const Node *src = static_cast<const Node*>(base);
+            const T *items = &(*src)[0];
+            size_ += appendPacked(sent_, items, items + src->count());
+        }
+        rebuildIndexTable();
+    }
+
+    // Bytes from the read position to the end, -1 for streams that cannot seek
+    static std::streamoff bytesLeft(std::istream &is) {
+        const std::streampos start = is.tellg();
+        if (start == std::streampos(-1))
+            return -1;
+
+        is.seekg(0, std::ios::end);
+        const std::streampos end = is.tellg();
+        is.clear();
+        is.seekg(start);
+        return end == std::streampos(-1) ? -1 : std::streamoff(end - start);
+    }
+
+    static void readBytes(std::istream &is, void *bytes, size_t size) {
+        if (!is.read(static_cast<char*>(bytes), size))
+            throw std::runtime_error("Unexpected end of BlockList file");
+    }
+
+    template <typename... Args>
+    Iterator emplaceAt(Node *curr, size_t nodeStart, size_t offset, Args &&...args) {
+        if (curr->filled()) {
+            // An argument may refer into the block that is about to be split
+            if ((curr->holds(std::addressof(args)) || ...)) {
+                T value(std::forward<Args>(args)...);
+                return emplaceAt(curr, nodeStart, offset, std::move(value));
+            }
+
+            Node *add = splitNode(curr, nodeStart);
+            if (offset > curr->count()) {
+                offset -= curr->count();
+                nodeStart += curr->count();
+                curr = add;
+            }
+        }
+
+        curr->emplace(offset, std::forward<Args>(args)...);
+        ++size_;
+        adjustIndex(curr, nodeStart, 1);
+        return Iterator(this, curr, offset, nodeStart + offset);
+    }
+
+    // Constructs the first item of a node that is not linked yet, the node
+    // is freed again when the constructor throws
+    template <typename... Args>
+    T &emplaceInto(Node *add, Args &&...args) {
+        try {
+            return add->emplace(0, std::forward<Args>(args)...);
+        } catch (...) {
+            destroyNode(add);
+            throw;
+        }
+    }
+
+    // Moves the upper half of a node into a new node linked right after it
+    Node *splitNode(Node *node, size_t nodeStart) {
+        const size_t keep = node->count() / 2;
+        const size_t moved = node->count() - keep;
+
+        Node *add = createNode();
+        node->moveTailTo(*add, keep);
+        table_.adjust(node, nodeStart, -std::ptrdiff_t(moved));
+
+        linkNode(node, add, node->next, nodeStart + keep);
+        return add;
+    }
+
+    Iterator eraseAt(Node *node, size_t nodeStart, size_t offset) {
+        const size_t pos = nodeStart + offset;
+
+        node->erase(offset);
+        table_.adjust(node, nodeStart, -1);
+        --size_;
+
+        Iterator next(this, node, offset, pos);
+        if (offset == node->count())
+            next = Iterator(this, node->next, 0, pos);
+
+        if (node->empty()) {
+            unlinkNode(node, nodeStart);
+        } else if (node->count() < MIN_FILL && rebalance(node, nodeStart)) {
+            next = iteratorAt(pos);
+        }
+
+        if (size_ == 0)
+            table_.clear();
+        maintainIndex();
+
+        return next;
+    }
+
+    void unlinkNode(Node *node, size_t nodeStart) {
+        table_.eraseNode(node, nodeStart);
+
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+
+        destroyNode(node);
+    }
 
-        insertNodeBetween(sent_, add, sent_);
+    // Merges an underfull node into a neighbour when both fit in one block,
+    // otherwise borrows items to even the pair out. Returns whether any
+    // items moved.
+    bool rebalance(Node *node, size_t nodeStart) {
+        Node *prev = node->prev != sent_ ? static_cast<Node*>(node->prev) : nullptr;
+        Node *next = node->next != sent_ ? static_cast<Node*>(node->next) : nullptr;
+        const size_t count = node->count();
+
+        if (prev && prev->count() + count <= CAPACITY) {
+            const size_t prevStart = nodeStart - prev->count();
+            node->moveTailTo(*prev, 0);
+            table_.adjust(prev, prevStart, count);
+            table_.adjust(node, nodeStart + count, -std::ptrdiff_t(count));
+            unlinkNode(node, nodeStart + count);
+            return true;
+        }
+
+        if (next && next->count() + count <= CAPACITY) {
+            const size_t moved = next->count();
+            next->moveHeadTo(*node, moved);
+            table_.adjust(node, nodeStart, moved);
+            table_.adjust(next, nodeStart + count + moved, -std::ptrdiff_t(moved));
+            unlinkNode(next, nodeStart + count + moved);
+            return true;
+        }
+
+        if (next) {
+            const size_t moved = (next->count() - count) / 2;
+            next->moveHeadTo(*node, moved);
+            table_.adjust(node, nodeStart, moved);
+            table_.adjust(next, nodeStart + count + moved, -std::ptrdiff_t(moved));
+            return true;
+        }
+
+        if (prev) {
+            const size_t moved = (prev->count() - count) / 2;
+            const size_t prevStart = nodeStart - prev->count();
+            prev->moveTailToFront(*node, prev->count() - moved);
+            table_.adjust(prev, prevStart, -std::ptrdiff_t(moved));
+            table_.adjust(node, nodeStart - moved, moved);
+            return true;
+        }
+
+        return false;
+    }
+
+    // Item position where 'before' turns false, node is nullptr at the end
+    struct Bound {
+        Node *node{};
+        size_t nodeStart{};
+        size_t offset{};
+    };
+
+    template <typename Pred>
+    Bound findBound(Pred before) const {
+        const auto blockBefore = [&before](const Node &node) {
+            return before(node[node.count() - 1]);
+        };
+        const auto found = table_.partitionPoint(blockBefore, sent_);
+        if (!found.node)
+            return {nullptr, size_, 0};
+
+        const T *items = &(*found.node)[0];
+        const T *point = std::partition_point(items, items + found.node->count(), before);
+        return {found.node, found.index, size_t(point - items)};
+    }
+
+    Iterator iteratorAt(size_t pos) {
+        if (pos == size_)
+            return end();
+
+        size_t nodeStart{};
+        Node *node = findNode(pos, nodeStart);
+        return Iterator(this, node, pos - nodeStart, pos);
+    }
+
+    // Lookups through a non-const list also move the finger. Const ones
+    // only read it, so threads reading the same list write nothing shared.
+    Node *findNode(size_t pos, size_t &nodeStart) {
+        Node *node = std::as_const(*this).findNode(pos, nodeStart);
+        table_.setFinger(node, nodeStart);
+        return node;
+    }
+
+    Node *findNode(size_t pos, size_t &nodeStart) const {
+        const auto found = table_.findClosest(pos);
+        Node *curr = found.node ? found.node : static_cast<Node*>(sent_->next);
+        nodeStart = found.index;
+        size_t hops{};
 
-        table_.insert(0, add);
+        while (pos < nodeStart) {
+            curr = static_cast<Node*>(curr->prev);
+            nodeStart -= curr->count();
+            ++hops;
+        }
+        while (nodeStart + curr->count() <= pos) {
+            nodeStart += curr->count();
+            curr = static_cast<Node*>(curr->next);
+            ++hops;
+        }
+
+        stats_.countLookup(hops, found.indexed);
+        return curr;
     }
 
-    Node *findNode(size_t pos, size_t &posInNode) const {
-        auto found = table_.findClosest(pos);
-        Node *curr = found.node;
-        size_t nodeStart = found.index;
+    Node *findNodeIndexed(size_t pos, size_t &nodeStart) const {
+        const auto found = table_.findIndexed(pos);
+        Node *curr = found.node ? found.node : static_cast<Node*>(sent_->next);
+        nodeStart = found.index;
 
         while (nodeStart + curr->count() <= pos) {
             nodeStart += curr->count();
             curr = static_cast<Node*>(curr->next);
         }
 
-        posInNode = pos - nodeStart;
         return curr;
     }
 
     size_t size_;
     NodeBase *sent_;
     IndexTable table_{};
+    NodeAllocator alloc_{};
+
+    [[no_unique_address]] Counters stats_{};
 };
 
+#endif // BLOCKLIST_H
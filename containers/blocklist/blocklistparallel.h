@@ -0,0 +1,164 @@
+#ifndef BLOCKLISTPARALLEL_H
+#define BLOCKLISTPARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "blocklist.h"
+#include "threadpool.h"
+
+// Parallel algorithms over a BlockList. They split the chain into one run of
+// whole blocks per worker and must not be mixed with edits of the list. The
+// pool defaults to ThreadPool::shared(), which is sized to the machine.
+// Kept apart from blocklist.h so that only their users link Threads.
+
+namespace Details {
+
+// Reaches into the blocks of a BlockList, which befriends it
+struct BlockListParallel
+{
+    // A run of whole blocks [first, end) whose items start at 'start'
+    struct Part {
+        size_t number{};
+        BlockListNodeBase *first{};
+        BlockListNodeBase *end{};
+        size_t start{};
+    };
+
+    // Cuts the chain at the blocks holding every size / threads-th item and
+    // hands the runs to the pool, a single run is processed on this thread
+    template <typename List, typename Fn>
+    static void runParts(const List &list, ThreadPool &pool, Fn &&fn) {
+        if (list.empty())
+            return;
+
+        const size_t size = list.size();
+        const size_t wanted = std::min(pool.threadCount(), size);
+        std::vector<Part> parts;
+        parts.reserve(wanted);
+
+        Part part{0, list.sent_->next, list.sent_, 0};
+        for (size_t k = 1; k < wanted; ++k) {
+            size_t nodeStart{};
+            auto *node = list.findNode(k * size / wanted, nodeStart);
+            if (nodeStart == part.start)
+                continue;
+
+            part.end = node;
+            parts.push_back(part);
+            part = {parts.size(), node, list.sent_, nodeStart};
+        }
+        parts.push_back(part);
+
+        if (parts.size() == 1) {
+            fn(parts.front());
+            return;
+        }
+        pool.run(parts.size(), [&](size_t i) { fn(parts[i]); });
+    }
+
+    // Calls fn(item, position) for every item of the run, items of a const
+    // list are passed as const
+    template <typename List, typename Fn>
+    static void forEachIn(const Part &part, Fn &&fn) {
+        using Node = std::conditional_t<std::is_const_v<List>,
+                                        const typename std::remove_const_t<List>::Node,
+                                        typename std::remove_const_t<List>::Node>;
+
+        size_t pos = part.start;
+        for (BlockListNodeBase *base = part.first; base != part.end; base = base->next) {
+            Node *node = static_cast<Node*>(base);
+            for (size_t i = 0; i < node->count(); ++i, ++pos)
+                fn((*node)[i], pos);
+        }
+    }
+
+    template <typename List, typename Fn>
+    static void forEach(List &list, Fn &fn, ThreadPool &pool) {
+        runParts(list, pool, [&fn](const Part &part) {
+            forEachIn<List>(part, [&fn](auto &item, size_t) { fn(item); });
+        });
+    }
+
+    template <typename List, typename R, typename Op>
+    static R reduce(const List &list, R init, Op &op, ThreadPool &pool) {
+        std::vector<std::optional<R>> partials(pool.threadCount());
+        runParts(list, pool, [&](const Part &part) {
+            std::optional<R> &acc = partials[part.number];
+            forEachIn<const List>(part, [&](const auto &item, size_t) {
+                if (acc)
+                    acc = op(std::move(*acc), item);
+                else
+                    acc.emplace(item);
+            });
+        });
+
+        for (std::optional<R> &partial : partials) {
+            if (partial)
+                init = op(std::move(init), std::move(*partial));
+        }
+        return init;
+    }
+
+    template <typename List, typename RandomIt, typename Fn>
+    static void transform(const List &list, RandomIt dest, Fn &fn, ThreadPool &pool) {
+        runParts(list, pool, [&](const Part &part) {
+            forEachIn<const List>(part, [&](const auto &item, size_t pos) {
+                dest[pos] = fn(item);
+            });
+        });
+    }
+};
+
+}
+
+template <typename T, typename IndexPolicy, uint16_t CAPACITY, typename AllocPolicy, typename CountingPolicy,
+          typename Fn>
+void parallelForEach(BlockList<T, IndexPolicy, CAPACITY, AllocPolicy, CountingPolicy> &list, Fn fn,
+                     ThreadPool &pool = ThreadPool::shared()) {
+    Details::BlockListParallel::forEach(list, fn, pool);
+}
+
+template <typename T, typename IndexPolicy, uint16_t CAPACITY, typename AllocPolicy, typename CountingPolicy,
+          typename Fn>
+void parallelForEach(const BlockList<T, IndexPolicy, CAPACITY, AllocPolicy, CountingPolicy> &list, Fn fn,
+                     ThreadPool &pool = ThreadPool::shared()) {
+    Details::BlockListParallel::forEach(list, fn, pool);
+}
+
+// Folds every run on its own and then the partial results in list order.
+// As with std::reduce, 'op' has to be associative but need not be
+// commutative. Each run starts from its first item converted to R, so R
+// must be constructible from T and 'op' is called both as op(R, const T&)
+// within a run and as op(R, R) to combine the runs with 'init'.
+template <typename T, typename IndexPolicy, uint16_t CAPACITY, typename AllocPolicy, typename CountingPolicy,
+          typename R, typename Op>
+R parallelReduce(const BlockList<T, IndexPolicy, CAPACITY, AllocPolicy, CountingPolicy> &list, R init, Op op,
+                 ThreadPool &pool = ThreadPool::shared()) {
+    return Details::BlockListParallel::reduce(list, std::move(init), op, pool);
+}
+
+// Replaces every item with fn(item)
+template <typename T, typename IndexPolicy, uint16_t CAPACITY, typename AllocPolicy, typename CountingPolicy,
+          typename Fn>
+void parallelTransform(BlockList<T, IndexPolicy, CAPACITY, AllocPolicy, CountingPolicy> &list, Fn fn,
+                       ThreadPool &pool = ThreadPool::shared()) {
+    parallelForEach(list, [&fn](T &item) { item = fn(item); }, pool);
+}
+
+// Writes fn(item) to dest[index of item]
+template <typename T, typename IndexPolicy, uint16_t CAPACITY, typename AllocPolicy, typename CountingPolicy,
+          typename RandomIt, typename Fn,
+          typename = std::enable_if_t<std::is_base_of_v<std::random_access_iterator_tag,
+              typename std::iterator_traits<RandomIt>::iterator_category>>>
+void parallelTransform(const BlockList<T, IndexPolicy, CAPACITY, AllocPolicy, CountingPolicy> &list, RandomIt dest, Fn fn,
+                       ThreadPool &pool = ThreadPool::shared()) {
+    Details::BlockListParallel::transform(list, dest, fn, pool);
+}
+
+#endif // BLOCKLISTPARALLEL_H
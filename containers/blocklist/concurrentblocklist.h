@@ -0,0 +1,282 @@
+#ifndef CONCURRENTBLOCKLIST_H
+#define CONCURRENTBLOCKLIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "blocklist.h"
+
+namespace Details {
+
+// Index hook that also carries the lock of its block
+template <typename Hook>
+struct LockedHook : Hook {
+    mutable std::shared_mutex lock;
+};
+
+}
+
+namespace BlockListIndex {
+
+// Same index as Policy, with a lock in every node
+template <typename Policy>
+struct Locked {
+    using Hook = Details::LockedHook<typename Policy::Hook>;
+
+    template <typename Node>
+    using Index = typename Policy::template Index<Node>;
+};
+
+}
+
+// BlockList shared between threads, guarded by three kinds of lock taken
+// in this order:
+// - the structure lock, shared by everything except the edits that link or
+//   unlink blocks (splits, merges, clear and compact), which take it
+//   exclusively;
+// - the lock of each block, held while its items are read or written;
+// - the index lock, covering the block counts and the index. It is only
+//   held for short spells and never while waiting for a block: an item is
+//   located under it shared, its block is locked, and the location is
+//   checked again under it before use. An insert or erase that stays inside
+//   its block holds it exclusively just while it shifts that block and
+//   updates the counts.
+// Workers on different blocks therefore only meet in those short spells,
+// and readers of one block share its lock.
+template <typename T,
+          typename IndexPolicy = BlockListIndex::Counted,
+          uint16_t CAPACITY = Details::defaultBlockCapacity<T>()>
+class ConcurrentBlockList
+{
+    using List = BlockList<T, BlockListIndex::Locked<IndexPolicy>, CAPACITY>;
+    using Node = typename List::Node;
+    using NodeBase = Details::BlockListNodeBase;
+
+    using ReadLock  = std::shared_lock<std::shared_mutex>;
+    using WriteLock = std::unique_lock<std::shared_mutex>;
+
+public:
+    using value_type = T;
+
+    ConcurrentBlockList() = default;
+
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    ConcurrentBlockList(InputIt first, InputIt last)
+        : list_(first, last) {}
+
+    ConcurrentBlockList(const ConcurrentBlockList &other) = delete;
+    ConcurrentBlockList &operator=(const ConcurrentBlockList &other) = delete;
+
+    size_t size() const {
+        ReadLock structure(structure_);
+        ReadLock index(index_);
+        return list_.size();
+    }
+
+    bool empty() const {
+        ReadLock structure(structure_);
+        return list_.empty();
+    }
+
+    T get(size_t pos) const {
+        ReadLock structure(structure_);
+        ReadLock block;
+        size_t nodeStart{};
+        const Node *node = lockItem(pos, Slot::Item, nodeStart, block);
+        return (*node)[pos - nodeStart];
+    }
+
+    template <typename U>
+    void set(size_t pos, U &&item) {
+        update(pos, [&item](T &target) { target = std::forward<U>(item); });
+    }
+
+    // Calls fn(const T&) with the block of the item locked for reading
+    template <typename Fn>
+    void read(size_t pos, Fn fn) const {
+        ReadLock structure(structure_);
+        ReadLock block;
+        size_t nodeStart{};
+        const Node *node = lockItem(pos, Slot::Item, nodeStart, block);
+        fn((*node)[pos - nodeStart]);
+    }
+
+    // Calls fn(T&) with the block of the item locked for writing
+    template <typename Fn>
+    void update(size_t pos, Fn fn) {
+        ReadLock structure(structure_);
+        WriteLock block;
+        size_t nodeStart{};
+        Node *node = lockItem(pos, Slot::Item, nodeStart, block);
+        fn((*node)[pos - nodeStart]);
+    }
+
+    // Visits the items in order, one block locked at a time
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        ReadLock structure(structure_);
+        for (const NodeBase *base = list_.sent_->next; base != list_.sent_; base = base->next) {
+            const Node *node = static_cast<const Node*>(base);
+            ReadLock block(node->lock);
+            for (size_t i = 0; i < node->count(); ++i)
+                fn((*node)[i]);
+        }
+    }
+
+    std::vector<T> toVector() const {
+        std::vector<T> items;
+        forEach([&items](const T &item) { items.push_back(item); });
+        return items;
+    }
+
+    // Inserts and erases lock only their block unless it has to be split
+    // or merged, then they retry with the structure lock held exclusively
+    template <typename U>
+    void insertFront(U &&item) {
+        if (insertInBlock<U>(0, Slot::Insert, item))
+            return;
+
+        WriteLock structure(structure_);
+        list_.insertFront(std::forward<U>(item));
+    }
+
+    template <typename U>
+    void insertBack(U &&item) {
+        if (insertInBlock<U>(0, Slot::Back, item))
+            return;
+
+        WriteLock structure(structure_);
+        list_.insertBack(std::forward<U>(item));
+    }
+
+    template <typename U>
+    void insert(size_t pos, U &&item) {
+        if (insertInBlock<U>(pos, Slot::Insert, item))
+            return;
+
+        WriteLock structure(structure_);
+        list_.insert(pos, std::forward<U>(item));
+    }
+
+    void erase(size_t pos) {
+        if (eraseInBlock(pos))
+            return;
+
+        WriteLock structure(structure_);
+        list_.erase(pos);
+    }
+
+    void clear() {
+        WriteLock structure(structure_);
+        list_.clear();
+    }
+
+    void compact() {
+        WriteLock structure(structure_);
+        list_.compact();
+    }
+
+private:
+    // What a position names: an item, a place to insert at (the end
+    // included), or the end whatever the position
+    enum class Slot { Item, Insert, Back };
+
+    // Returns false without touching the list when the item does not fit
+    // into the block at 'pos' (or at the back)
+    template <typename U>
+    bool insertInBlock(size_t pos, Slot slot, std::remove_reference_t<U> &item) {
+        ReadLock structure(structure_);
+        WriteLock block;
+        WriteLock index;
+        size_t nodeStart{};
+        Node *node = lockItem(pos, slot, nodeStart, block, &index);
+        if (!node || node->filled())
+            return false;
+
+        node->emplace(pos - nodeStart, std::forward<U>(item));
+        ++list_.size_;
+        list_.adjustIndex(node, nodeStart, 1);
+        return true;
+    }
+
+    // Returns false without touching the list when the block would become
+    // underfull and has to be merged
+    bool eraseInBlock(size_t pos) {
+        ReadLock structure(structure_);
+        WriteLock block;
+        WriteLock index;
+        size_t nodeStart{};
+        Node *node = lockItem(pos, Slot::Item, nodeStart, block, &index);
+        if (node->count() <= std::max<size_t>(List::MIN_FILL, 1))
+            return false;
+
+        node->erase(pos - nodeStart);
+        --list_.size_;
+        list_.adjustIndex(node, nodeStart, -1);
+        return true;
+    }
+
+    // Locks the block of 'pos' into 'block', which is nullptr only for an
+    // insert into an empty list. Edits pass 'index' and get it back holding
+    // the index lock exclusively. The block is located with the index lock
+    // held shared but locked without it, so someone editing an earlier
+    // block can move 'pos' elsewhere in between: the location is checked
+    // again once both are held and looked up anew if it changed.
+    template <typename BlockLock>
+    Node *lockItem(size_t &pos, Slot slot, size_t &nodeStart, BlockLock &block,
+                   WriteLock *index = nullptr) const {
+        for (;;) {
+            Node *node{};
+            {
+                ReadLock locate(index_);
+                node = find(pos, slot, nodeStart);
+            }
+            if (!node)
+                return nullptr;
+
+            block = BlockLock(node->lock);
+            if (index) {
+                *index = WriteLock(index_);
+                if (find(pos, slot, nodeStart) == node)
+                    return node;
+                index->unlock();
+            } else {
+                ReadLock check(index_);
+                if (find(pos, slot, nodeStart) == node)
+                    return node;
+            }
+            block.unlock();
+        }
+    }
+
+    // Needs the index lock. An insert at the end goes to the last block.
+    Node *find(size_t &pos, Slot slot, size_t &nodeStart) const {
+        if (slot == Slot::Back)
+            pos = list_.size();
+        if (pos > list_.size() || (pos == list_.size() && slot == Slot::Item))
+            throw std::out_of_range("Index out of bounds");
+
+        if (pos < list_.size())
+            return list_.findNodeIndexed(pos, nodeStart);
+        if (list_.empty())
+            return nullptr;
+
+        Node *node = static_cast<Node*>(list_.sent_->prev);
+        nodeStart = pos - node->count();
+        return node;
+    }
+
+    List list_;
+    mutable std::shared_mutex structure_;
+    mutable std::shared_mutex index_;
+};
+
+#endif // CONCURRENTBLOCKLIST_H
@@ -0,0 +1,460 @@
+#ifndef COWBLOCKLIST_H
+#define COWBLOCKLIST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "blocklist.h"
+
+// BlockList variant whose copies are O(1) snapshots. Blocks and the treap
+// vertices indexing them are reference counted and shared between copies.
+// A mutation copies the touched block and the vertices on its path only
+// while another copy still refers to them, so memory grows with the edited
+// blocks. Different copies may be used from different threads.
+template <typename T, uint16_t CAPACITY = Details::defaultBlockCapacity<T>()>
+class CowBlockList
+{
+    using Block = Details::BlockListNode<T, Details::EmptyIndexHook, CAPACITY>;
+
+    // Blocks below this fill are merged with or topped up from a neighbour
+    static constexpr size_t MIN_FILL = CAPACITY / 4;
+
+    struct Vertex;
+    using VertexPtr = std::shared_ptr<Vertex>;
+
+    struct Vertex {
+        VertexPtr left{};
+        VertexPtr right{};
+        std::shared_ptr<Block> block{};
+        size_t total{};
+        uint32_t priority{};
+    };
+
+public:
+    using value_type = T;
+
+    // In-order walk keeping the vertices still to be visited on a stack.
+    // Invalidated by any mutation of the list it came from.
+    class ConstIterator
+    {
+        friend class CowBlockList;
+
+    public:
+        using value_type = T;
+        using reference = const T&;
+        using pointer = const T*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        ConstIterator() = default;
+
+        const T &operator*() const  { return (*stack_.back()->block)[offset_]; }
+        const T *operator->() const { return &**this; }
+
+        //prefix
+        ConstIterator &operator++() {
+            increment();
+            return *this;
+        }
+
+        //postfix
+        ConstIterator operator++(int) {
+            auto tmp = *this;
+            increment();
+            return tmp;
+        }
+
+        bool operator==(const ConstIterator &other) const { return pos_ == other.pos_; }
+        bool operator!=(const ConstIterator &other) const { return pos_ != other.pos_; }
+
+        size_t index() const { return pos_; }
+
+    private:
+        ConstIterator(const Vertex *root, size_t pos) : pos_(pos) {
+            pushLeft(root);
+        }
+
+        void pushLeft(const Vertex *v) {
+            for (; v; v = v->left.get())
+                stack_.push_back(v);
+        }
+
+        void increment() {
+            ++pos_;
+            if (++offset_ < stack_.back()->block->count())
+                return;
+
+            offset_ = 0;
+            const Vertex *done = stack_.back();
+            stack_.pop_back();
+            pushLeft(done->right.get());
+        }
+
+        std::vector<const Vertex*> stack_{};
+        size_t offset_{};
+        size_t pos_{};
+    };
+
+    CowBlockList() = default;
+
+    // Copies share everything with the original, so they are O(1)
+    CowBlockList(const CowBlockList &other) = default;
+    CowBlockList(CowBlockList &&other) noexcept = default;
+
+    template <typename InputIt,
+              typename = typename std::iterator_traits<InputIt>::iterator_category>
+    CowBlockList(InputIt first, InputIt last) {
+        assign(first, last);
+    }
+
+    CowBlockList(const std::initializer_list<T> &initList) {
+        assign(initList.begin(), initList.end());
+    }
+
+    CowBlockList &operator=(const CowBlockList &other) = default;
+    CowBlockList &operator=(CowBlockList &&other) noexcept = default;
+
+    CowBlockList snapshot() const { return *this; }
+
+    // Packs the range into full blocks and builds the treap in one pass
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        std::vector<VertexPtr> stack;
+        while (first != last) {
+            auto block = std::make_shared<Block>();
+            first = block->pushBackRange(first, last);
+            VertexPtr v = makeVertex(std::move(block));
+
+            VertexPtr popped;
+            while (!stack.empty() && stack.back()->priority < v->priority) {
+                popped = std::move(stack.back());
+                stack.pop_back();
+                finalize(*popped);
+            }
+
+            v->left = std::move(popped);
+            if (!stack.empty())
+                stack.back()->right = v;
+            stack.push_back(std::move(v));
+        }
+
+        root_ = stack.empty() ? nullptr : stack.front();
+        while (!stack.empty()) {
+            finalize(*stack.back());
+            stack.pop_back();
+        }
+    }
+
+    const T &operator[](size_t pos) const {
+        if (pos >= size())
+            throw std::out_of_range("Index out of bounds");
+
+        size_t offset{};
+        const Vertex *v = locate(pos, offset, false);
+        return (*v->block)[offset];
+    }
+
+    const T &at(size_t pos) const { return operator[](pos); }
+
+    ConstIterator begin()  const { return ConstIterator(root_.get(), 0); }
+    ConstIterator end()    const { return ConstIterator(nullptr, size()); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend()   const { return end(); }
+
+    size_t size()  const { return total(root_); }
+    bool   empty() const { return root_ == nullptr; }
+
+    template <typename U>
+    void set(size_t pos, U &&item) {
+        update(pos, [&item](T &target) { target = std::forward<U>(item); });
+    }
+
+    // Calls fn(T&) on the item after unsharing its block
+    template <typename Fn>
+    void update(size_t pos, Fn fn) {
+        if (pos >= size())
+            throw std::out_of_range("Index out of bounds");
+
+        size_t offset{};
+        Vertex *v = ownPath(pos, 0, offset, false);
+        fn((*ownBlock(v))[offset]);
+    }
+
+    template <typename U>
+    void insertFront(U &&item) {
+        insert(0, std::forward<U>(item));
+    }
+
+    template <typename U>
+    void insertBack(U &&item) {
+        insert(size(), std::forward<U>(item));
+    }
+
+    template <typename U>
+    void insert(size_t pos, U &&item) {
+        if (pos > size())
+            throw std::out_of_range("Index out of bounds");
+
+        if (empty()) {
+            auto block = std::make_shared<Block>();
+            block->pushBack(std::forward<U>(item));
+            root_ = makeVertex(std::move(block));
+            return;
+        }
+
+        size_t offset{};
+        if (locate(pos, offset, true)->block->filled()) {
+            // The item may live in the block that is about to be split
+            T value(std::forward<U>(item));
+            splitBlock(pos);
+            insert(pos, std::move(value));
+            return;
+        }
+
+        Vertex *v = ownPath(pos, 1, offset, true);
+        ownBlock(v)->push(offset, std::forward<U>(item));
+    }
+
+    void erase(size_t pos) {
+        if (pos >= size())
+            throw std::out_of_range("Index out of bounds");
+
+        size_t offset{};
+        Vertex *v = ownPath(pos, -1, offset, false);
+        Block *block = ownBlock(v);
+        block->erase(offset);
+
+        if (block->empty()) {
+            auto [before, rest] = split(std::move(root_), pos - offset);
+            root_ = merge(std::move(before), popEmptyLeftmost(std::move(rest)));
+        } else if (block->count() < MIN_FILL) {
+            rebalance(pos - offset);
+        }
+    }
+
+    void clear() {
+        root_.reset();
+    }
+
+private:
+    static size_t total(const VertexPtr &v) { return v ? v->total : 0; }
+
+    static void finalize(Vertex &v) {
+        v.total += total(v.left) + total(v.right);
+    }
+
+    VertexPtr makeVertex(std::shared_ptr<Block> block) {
+        auto v = std::make_shared<Vertex>();
+        v->total = block->count();
+        v->block = std::move(block);
+        v->priority = nextPriority();
+        return v;
+    }
+
+    // Gives the caller a vertex nobody else refers to. Copies only bump the
+    // counts of the children, which become shared in turn.
+    static Vertex *own(VertexPtr &v) {
+        if (v.use_count() != 1)
+            v = std::make_shared<Vertex>(*v);
+        else
+            std::atomic_thread_fence(std::memory_order_acquire);
+        return v.get();
+    }
+
+    static Block *ownBlock(Vertex *v) {
+        if (v->block.use_count() != 1) {
+            auto copy = std::make_shared<Block>();
+            const T *items = &(*v->block)[0];
+            copy->pushBackRange(items, items + v->block->count());
+            v->block = std::move(copy);
+        } else {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return v->block.get();
+    }
+
+    // 'atEnd' lets a position equal to a block's count land in that block,
+    // which is where inserts go
+    const Vertex *locate(size_t pos, size_t &offset, bool atEnd) const {
+        const Vertex *v = root_.get();
+        for (;;) {
+            const size_t left = total(v->left);
+            if (pos < left) {
+                v = v->left.get();
+                continue;
+            }
+
+            pos -= left;
+            const size_t count = v->block->count();
+            if (pos < count || (atEnd && pos == count)) {
+                offset = pos;
+                return v;
+            }
+            pos -= count;
+            v = v->right.get();
+        }
+    }
+
+    // Same descent as locate(), unsharing the path and adding delta to it
+    Vertex *ownPath(size_t pos, std::ptrdiff_t delta, size_t &offset, bool atEnd) {
+        VertexPtr *link = &root_;
+        for (;;) {
+            Vertex *v = own(*link);
+            v->total += delta;
+
+            const size_t left = total(v->left);
+            if (pos < left) {
+                link = &v->left;
+                continue;
+            }
+
+            pos -= left;
+            const size_t count = v->block->count();
+            if (pos < count || (atEnd && pos == count)) {
+                offset = pos;
+                return v;
+            }
+            pos -= count;
+            link = &v->right;
+        }
+    }
+
+    // Moves the upper half of the full block taking inserts at 'pos' into a
+    // new vertex right behind it
+    void splitBlock(size_t pos) {
+        size_t offset{};
+        const size_t count = locate(pos, offset, true)->block->count();
+        const size_t keep = count / 2;
+
+        Vertex *v = ownPath(pos, -std::ptrdiff_t(count - keep), offset, true);
+        auto rest = std::make_shared<Block>();
+        ownBlock(v)->moveTailTo(*rest, keep);
+
+        auto [before, after] = split(std::move(root_), pos - offset + keep);
+        root_ = merge(merge(std::move(before), makeVertex(std::move(rest))), std::move(after));
+    }
+
+    // Merges the underfull block starting at 'start' into a neighbour when
+    // both fit in one block, otherwise borrows items to even the pair out.
+    // A neighbour still shared with another copy is copied first.
+    void rebalance(size_t start) {
+        auto [before, rest] = split(std::move(root_), start);
+        const size_t count = firstCount(rest);
+        auto [mid, after] = split(std::move(rest), count);
+        Vertex *v = own(mid);
+        Block *block = ownBlock(v);
+
+        if (after) {
+            const size_t nextCount = firstCount(after);
+            auto [next, tail] = split(std::move(after), nextCount);
+            Vertex *n = own(next);
+            Block *nextBlock = ownBlock(n);
+
+            nextBlock->moveHeadTo(*block, count + nextCount <= CAPACITY ? nextCount : (nextCount - count) / 2);
+            v->total = block->count();
+            n->total = nextBlock->count();
+            if (nextBlock->empty())
+                next.reset();
+
+            root_ = merge(merge(merge(std::move(before), std::move(mid)), std::move(next)), std::move(tail));
+        } else if (before) {
+            const size_t prevCount = lastCount(before);
+            auto [head, prev] = split(std::move(before), total(before) - prevCount);
+            Vertex *p = own(prev);
+            Block *prevBlock = ownBlock(p);
+
+            if (prevCount + count <= CAPACITY) {
+                block->moveHeadTo(*prevBlock, count);
+                mid.reset();
+            } else {
+                const size_t moved = (prevCount - count) / 2;
+                prevBlock->moveTailToFront(*block, prevCount - moved);
+                v->total = block->count();
+            }
+            p->total = prevBlock->count();
+
+            root_ = merge(merge(std::move(head), std::move(prev)), std::move(mid));
+        } else {
+            root_ = std::move(mid);
+        }
+    }
+
+    static size_t firstCount(const VertexPtr &t) {
+        const Vertex *v = t.get();
+        while (v->left)
+            v = v->left.get();
+        return v->block->count();
+    }
+
+    static size_t lastCount(const VertexPtr &t) {
+        const Vertex *v = t.get();
+        while (v->right)
+            v = v->right.get();
+        return v->block->count();
+    }
+
+    // Splits into the vertices starting before 'pos' and the rest
+    static std::pair<VertexPtr, VertexPtr> split(VertexPtr t, size_t pos) {
+        if (!t)
+            return {};
+
+        Vertex *v = own(t);
+        if (pos <= total(v->left)) {
+            auto [before, rest] = split(std::move(v->left), pos);
+            v->total -= total(before);
+            v->left = std::move(rest);
+            return {std::move(before), std::move(t)};
+        }
+
+        const size_t passed = v->total - total(v->right);
+        auto [rest, after] = split(std::move(v->right), pos - passed);
+        v->total -= total(after);
+        v->right = std::move(rest);
+        return {std::move(t), std::move(after)};
+    }
+
+    static VertexPtr merge(VertexPtr a, VertexPtr b) {
+        if (!a) return b;
+        if (!b) return a;
+
+        if (a->priority > b->priority) {
+            Vertex *v = own(a);
+            v->total += b->total;
+            v->right = merge(std::move(v->right), std::move(b));
+            return a;
+        }
+
+        Vertex *v = own(b);
+        v->total += a->total;
+        v->left = merge(std::move(a), std::move(v->left));
+        return b;
+    }
+
+    // The leftmost vertex holds the block that just became empty
+    static VertexPtr popEmptyLeftmost(VertexPtr t) {
+        if (!t->left)
+            return std::move(t->right);
+
+        Vertex *v = own(t);
+        v->left = popEmptyLeftmost(std::move(v->left));
+        return t;
+    }
+
+    uint32_t nextPriority() {
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        return seed_;
+    }
+
+    VertexPtr root_{};
+    uint32_t seed_{2463534242u};
+};
+
+#endif // COWBLOCKLIST_H
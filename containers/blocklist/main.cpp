@@ -35,8 +35,8 @@ int main()
     //l.insert(1, "new3");
 
 
-    for (int i = 0; i < l.size(); ++i) {
-        std::cout << l[i] << "\n";
+    for (const auto &el : l) {
+        std::cout << el << "\n";
     }
 
     // std::cout << std::endl;
@@ -0,0 +1,140 @@
+#ifndef MAPPEDBLOCKLIST_H
+#define MAPPEDBLOCKLIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "blocklist.h"
+
+// Read-only view of a file written by BlockList::save(). The file is mapped
+// into memory and its blocks are used in place, so opening costs the same
+// for any size and pages are read in as they are touched. The items of all
+// blocks lie back to back in the file, which makes the view a plain array.
+// POSIX only.
+template <typename T>
+class MappedBlockList
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable items can be mapped");
+
+    using FileHeader = Details::BlockListFileHeader;
+
+public:
+    using value_type = T;
+    using ConstIterator = const T*;
+
+    explicit MappedBlockList(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open " + path);
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(FileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Not a BlockList file");
+        }
+
+        length_ = st.st_size;
+        mapping_ = ::mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping_ == MAP_FAILED) {
+            mapping_ = nullptr;
+            throw std::runtime_error("Cannot map " + path);
+        }
+
+        try {
+            const FileHeader &header = *static_cast<const FileHeader*>(mapping_);
+            header.check<T>();
+            header.checkSize(length_);
+
+            const char *bytes = static_cast<const char*>(mapping_);
+            counts_ = reinterpret_cast<const uint16_t*>(bytes + sizeof(FileHeader));
+            header.checkCounts(counts_);
+            items_ = reinterpret_cast<const T*>(bytes + header.itemsOffset);
+            blocks_ = header.blockCount;
+            size_ = header.itemCount;
+        } catch (...) {
+            ::munmap(mapping_, length_);
+            throw;
+        }
+    }
+
+    MappedBlockList(const MappedBlockList &other) = delete;
+    MappedBlockList &operator=(const MappedBlockList &other) = delete;
+
+    MappedBlockList(MappedBlockList &&other) noexcept
+        : mapping_(std::exchange(other.mapping_, nullptr)), length_(std::exchange(other.length_, 0)),
+          counts_(std::exchange(other.counts_, nullptr)), items_(std::exchange(other.items_, nullptr)),
+          blocks_(std::exchange(other.blocks_, 0)), size_(std::exchange(other.size_, 0)) {}
+
+    MappedBlockList &operator=(MappedBlockList &&other) noexcept {
+        if (this == &other) return *this;
+
+        unmap();
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        length_ = std::exchange(other.length_, 0);
+        counts_ = std::exchange(other.counts_, nullptr);
+        items_ = std::exchange(other.items_, nullptr);
+        blocks_ = std::exchange(other.blocks_, 0);
+        size_ = std::exchange(other.size_, 0);
+
+        return *this;
+    }
+
+    ~MappedBlockList() {
+        unmap();
+    }
+
+    const T &operator[](size_t pos) const {
+        if (pos >= size_)
+            throw std::out_of_range("Index out of bounds");
+        return items_[pos];
+    }
+
+    const T &at(size_t pos) const { return operator[](pos); }
+
+    ConstIterator begin()  const { return items_; }
+    ConstIterator end()    const { return items_ + size_; }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend()   const { return end(); }
+
+    const T *data() const { return items_; }
+
+    size_t size()  const { return size_; }
+    bool   empty() const { return size_ == 0; }
+
+    // The block layout the list had when it was saved
+    size_t blockCount() const { return blocks_; }
+
+    uint16_t blockSize(size_t block) const {
+        if (block >= blocks_)
+            throw std::out_of_range("Index out of bounds");
+        return counts_[block];
+    }
+
+    // Copies the items into a list that can be edited
+    template <typename List = BlockList<T>>
+    List toBlockList() const {
+        return List(begin(), end());
+    }
+
+private:
+    void unmap() {
+        if (mapping_)
+            ::munmap(mapping_, length_);
+    }
+
+    void *mapping_{};
+    size_t length_{};
+    const uint16_t *counts_{};
+    const T *items_{};
+    size_t blocks_{};
+    size_t size_{};
+};
+
+#endif // MAPPEDBLOCKLIST_H
@@ -0,0 +1,102 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed set of workers fed from one task queue. Tasks must not wait on
+// other tasks of the same pool.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) {
+        if (threads == 0)
+            threads = 1;
+
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i)
+            workers_.emplace_back([this] { work(); });
+    }
+
+    ThreadPool(const ThreadPool &other) = delete;
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+
+        for (std::thread &worker : workers_)
+            worker.join();
+    }
+
+    // Pool sized to the machine, created on first use
+    static ThreadPool &shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t threadCount() const { return workers_.size(); }
+
+    template <typename Fn>
+    std::future<void> submit(Fn &&fn) {
+        std::packaged_task<void()> task(std::forward<Fn>(fn));
+        std::future<void> result = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push(std::move(task));
+        }
+        wake_.notify_one();
+
+        return result;
+    }
+
+    // Runs fn(0) ... fn(count - 1) on the workers and waits for all of them,
+    // the first exception thrown by a task is rethrown here
+    template <typename Fn>
+    void run(size_t count, Fn &&fn) {
+        std::vector<std::future<void>> results;
+        results.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            results.push_back(submit([&fn, i] { fn(i); }));
+
+        for (std::future<void> &result : results)
+            result.wait();
+        for (std::future<void> &result : results)
+            result.get();
+    }
+
+private:
+    void work() {
+        for (;;) {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                    return;
+
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::queue<std::packaged_task<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_{};
+};
+
+#endif // THREADPOOL_H
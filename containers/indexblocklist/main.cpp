@@ -3,7 +3,10 @@
 #include "blocklist.h"
 
 template <typename T>
-void rebuildTableTest(const BlockList<T> &l) {
+using SparseBlockList = BlockList<T, BlockListIndex::Sparse>;
+
+template <typename T>
+void rebuildTableTest(SparseBlockList<T> &l) {
     std::cout << "Before rebuild: \n";
     l.printIndexTable();
     std::cout << std::endl;
@@ -22,7 +25,7 @@ void rebuildTableTest(const BlockList<T> &l) {
 
 int main()
 {
-    BlockList<std::string> l;
+    SparseBlockList<std::string> l;
     for (int i = 0; i < 10; ++i) {
          l.insertBack("str" + std::to_string(i + 1));
     }
@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "benchutils.h"
+#include "nvector.h"
+#include "smallvector.h"
+
+namespace {
+
+using Bench::makeItem;
+using Bench::nsPerOp;
+using Bench::weigh;
+
+constexpr size_t VECTORS = 1000000;
+
+template <typename V> void add(V &v, const typename V::value_type &x) { v.pushBack(x); }
+template <typename T> void add(std::vector<T> &v, const T &x)          { v.push_back(x); }
+
+// Lengths drawn uniformly from [0, maxLength]
+std::vector<size_t> lengths(size_t maxLength) {
+    std::mt19937 rng(1);
+    std::vector<size_t> result(VECTORS);
+    for (size_t &n : result)
+        n = rng() % (maxLength + 1);
+    return result;
+}
+
+size_t sink{};
+
+template <typename V>
+void runOne(const char *name, const std::vector<size_t> &lens) {
+    using T = typename V::value_type;
+
+    // A temporary per request: built, read once and dropped
+    const double scratch = nsPerOp(lens.size(), [&] {
+        size_t sum{};
+        for (size_t n : lens) {
+            V v;
+            for (size_t i = 0; i < n; ++i)
+                add(v, makeItem<T>(i));
+            for (const T &x : v)
+                sum += weigh(x);
+        }
+        sink += sum;
+    });
+
+    // Many short vectors kept alive side by side, then scanned
+    std::vector<V> all(lens.size());
+    const double build = nsPerOp(lens.size(), [&] {
+        for (size_t k = 0; k < lens.size(); ++k)
+            for (size_t i = 0; i < lens[k]; ++i)
+                add(all[k], makeItem<T>(i));
+    });
+
+    const double scan = nsPerOp(lens.size(), [&] {
+        size_t sum{};
+        for (const V &v : all)
+            for (const T &x : v)
+                sum += weigh(x);
+        sink += sum;
+    });
+
+    const double drop = nsPerOp(lens.size(), [&] { std::vector<V>().swap(all); });
+
+    std::cout << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << scratch
+              << std::setw(10) << build
+              << std::setw(10) << scan
+              << std::setw(10) << drop << "\n";
+}
+
+template <typename T>
+void runAll(const char *typeName, size_t maxLength) {
+    const auto lens = lengths(maxLength);
+    std::cout << typeName << ", lengths 0.." << maxLength << "\n";
+    runOne<NVector<T>>("NVector", lens);
+    runOne<SmallVector<T, 16>>("SmallVector<16>", lens);
+    runOne<std::vector<T>>("std::vector", lens);
+    std::cout << "\n";
+}
+
+}
+
+int main()
+{
+    std::cout << "ns per vector, " << VECTORS << " vectors\n";
+    std::cout << std::left << std::setw(28) << "container"
+              << std::right << std::setw(10) << "scratch"
+              << std::setw(10) << "build"
+              << std::setw(10) << "scan"
+              << std::setw(10) << "drop" << "\n";
+
+    runAll<int>("int", 16);
+    runAll<int>("int", 64);
+    runAll<std::string>("std::string", 16);
+
+    Bench::keep(sink);
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include "vectorbase.h"
+
+// NVector with room for N items inside the object itself. The allocator is
+// only used once more than N items are held, so short vectors never
+// allocate. Moving a vector whose items are inline moves the items one by one.
+template<typename T, size_t N, typename Allocator = std::allocator<T>>
+class SmallVector : public Details::VectorBase<T, Allocator, N>
+{
+    static_assert(N > 0, "Inline capacity must be positive");
+
+    using Base = Details::VectorBase<T, Allocator, N>;
+
+public:
+    static constexpr size_t INLINE_CAPACITY = N;
+
+    using Base::Base;
+
+    // Whether the items are still held in the object itself
+    bool isInline() const { return Base::usesInline(); }
+};
+
+namespace pmr {
+
+// SmallVector whose items spill into a std::pmr::memory_resource
+template<typename T, size_t N>
+using SmallVector = ::SmallVector<T, N, std::pmr::polymorphic_allocator<T>>;
+
+}
+
+#endif // SMALLVECTOR_H
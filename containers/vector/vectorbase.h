@@ -0,0 +1,879 @@
+#ifndef VECTORBASE_H
+#define VECTORBASE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "debuglog.h"
+
+namespace Details {
+
+// Room for N items inside the vector object itself
+template<typename T, size_t N>
+class InlineStorage
+{
+protected:
+    T* inlineData() { return reinterpret_cast<T*>(m_buffer); }
+    const T* inlineData() const { return reinterpret_cast<const T*>(m_buffer); }
+
+private:
+    alignas(T) unsigned char m_buffer[sizeof(T) * N];
+};
+
+template<typename T>
+class InlineStorage<T, 0>
+{
+protected:
+    T* inlineData() { return nullptr; }
+    const T* inlineData() const { return nullptr; }
+};
+
+// The implementation shared by NVector and SmallVector. Items live in raw
+// storage: only [0, m_size) are constructed objects, the slots up to
+// m_capacity are left untouched until something is put there. The first N
+// slots are inline, storage for more comes from the allocator, and items
+// are built and destroyed through std::allocator_traits, so pmr allocators
+// hand their resource on to items that take one. Moving a vector whose
+// items are inline moves the items one by one.
+template<typename T, typename Allocator, size_t N>
+class VectorBase : private InlineStorage<T, N>
+{
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>, "Allocator must allocate T");
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>, "Allocator must hand out plain pointers");
+
+    // Trivially copyable items are relocated with memcpy. With the default
+    // allocator their heap storage comes from malloc, so growth can use realloc.
+    static constexpr bool TRIVIAL = std::is_trivially_copyable_v<T>;
+    static constexpr bool REALLOC = TRIVIAL && std::is_same_v<Allocator, std::allocator<T>>
+                                    && alignof(T) <= alignof(std::max_align_t);
+
+    using InlineStorage<T, N>::inlineData;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    //CONSTRUCTORS
+    VectorBase() = default;
+
+    explicit VectorBase(const Allocator& alloc)
+        : m_alloc{ alloc } {}
+
+    explicit VectorBase(size_t size, const Allocator& alloc = Allocator())
+        : m_alloc{ alloc }
+    {
+        DEBUG_LOG("NVector(size_t size)");
+
+        initStorage(size);
+        constructOrFree([&] { valueConstruct(m_data, size); });
+        m_size = size;
+    }
+
+    VectorBase(size_t size, const T &init, const Allocator& alloc = Allocator())
+        : m_alloc{ alloc }
+    {
+        DEBUG_LOG("size_t size, const T& init");
+
+        initStorage(size);
+        constructOrFree([&] { fillConstruct(m_data, size, init); });
+        m_size = size;
+    }
+
+    VectorBase(const VectorBase& other)
+        : VectorBase(other, AllocTraits::select_on_container_copy_construction(other.m_alloc)) {}
+
+    VectorBase(const VectorBase& other, const Allocator& alloc)
+        : m_alloc{ alloc }, m_growthFactor{ other.m_growthFactor }
+    {
+        DEBUG_LOG("NVector(const NVector& other))");
+
+        initStorage(other.m_size);
+        constructOrFree([&] { copyConstruct(other.begin(), other.end(), m_data); });
+        m_size = other.m_size;
+    }
+
+    VectorBase(VectorBase&& other) noexcept(N == 0 || std::is_nothrow_move_constructible_v<T>)
+        : m_alloc{ std::move(other.m_alloc) }, m_growthFactor{ other.m_growthFactor }
+    {
+        DEBUG_LOG("NVector(NVector&& other)");
+
+        take(other);
+    }
+
+    // Takes the storage of 'other' when the allocators are equal, otherwise
+    // moves the items one by one
+    VectorBase(VectorBase&& other, const Allocator& alloc)
+        : m_alloc{ alloc }, m_growthFactor{ other.m_growthFactor }
+    {
+        DEBUG_LOG("NVector(NVector&& other, const Allocator& alloc)");
+
+        if (m_alloc == other.m_alloc) {
+            take(other);
+            return;
+        }
+
+        initStorage(other.m_size);
+        constructOrFree([&] {
+            copyConstruct(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()), m_data);
+        });
+        m_size = other.m_size;
+    }
+
+    template<typename InputIt,
+             typename = typename std::iterator_traits<InputIt>::iterator_category>
+    VectorBase(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : m_alloc{ alloc }
+    {
+        DEBUG_LOG("NVector(InputIt first, InputIt last)");
+
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+            const size_t size = std::distance(first, last);
+            initStorage(size);
+            constructOrFree([&] { copyConstruct(first, last, m_data); });
+            m_size = size;
+        } else {
+            append(first, last);
+        }
+    }
+
+    VectorBase(const std::initializer_list<T>& initList, const Allocator& alloc = Allocator())
+        : m_alloc{ alloc }
+    {
+        DEBUG_LOG("NVector(const std::initializer_list<T>& initList)");
+
+        initStorage(initList.size());
+        constructOrFree([&] { copyConstruct(initList.begin(), initList.end(), m_data); });
+        m_size = initList.size();
+    }
+
+    ~VectorBase()
+    {
+        destroy(m_data, m_data + m_size);
+        freeStorage();
+    }
+
+    //OPERATORS
+    VectorBase& operator=(const VectorBase& other)
+    {
+        DEBUG_LOG("operator=(const NVector& other)");
+
+        if (&other == this) return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (m_alloc != other.m_alloc) {
+                // The storage has to go back to the allocator it came from
+                releaseStorage();
+            }
+            m_alloc = other.m_alloc;
+        }
+
+        assignFrom(other.begin(), other.end(), other.m_size);
+        return *this;
+    }
+
+    VectorBase& operator=(VectorBase&& other) noexcept((AllocTraits::propagate_on_container_move_assignment::value
+                                                        || AllocTraits::is_always_equal::value)
+                                                       && (N == 0 || std::is_nothrow_move_constructible_v<T>))
+    {
+        DEBUG_LOG("operator=(NVector&& other)");
+
+        if (&other == this) return *this;
+
+        if constexpr (!AllocTraits::propagate_on_container_move_assignment::value
+                      && !AllocTraits::is_always_equal::value) {
+            // Storage of another allocator cannot be taken over
+            if (m_alloc != other.m_alloc) {
+                assignFrom(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()),
+                           other.m_size);
+                return *this;
+            }
+        }
+
+        releaseStorage();
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value)
+            m_alloc = std::move(other.m_alloc);
+
+        take(other);
+        return *this;
+    }
+
+    T& operator[](size_t index)
+    {
+        if (index >= m_size)
+            throw std::out_of_range("Index out of bounds");
+        return m_data[index];
+    }
+
+    const T& operator[](size_t index) const
+    {
+        if (index >= m_size)
+            throw std::out_of_range("Index out of bounds");
+        return m_data[index];
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const VectorBase& vec)
+    {
+        for (const auto& elem : vec)
+            os << elem << "\n";
+        return os;
+    }
+
+    //METHODS
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+
+    Allocator getAllocator() const { return m_alloc; }
+
+    T* begin() { return m_data; }
+    T* end()   { return m_data + m_size; }
+
+    const T* begin() const { return m_data; }
+    const T* end()   const { return m_data + m_size; }
+
+    // Full storage grows to capacity * factor slots. The factor belongs to
+    // the vector: copies and moves start with it, assignments keep their own.
+    double growthFactor() const { return m_growthFactor; }
+
+    void setGrowthFactor(double factor)
+    {
+        if (!(factor > 1.0))
+            throw std::invalid_argument("Growth factor must be greater than 1");
+        m_growthFactor = factor;
+    }
+
+    template<typename U>
+    void pushBack(U&& item)
+    {
+        emplaceBack(std::forward<U>(item));
+
+#ifdef DEBUG
+        bool isLVal = std::is_lvalue_reference_v<U>;
+        if (isLVal)
+            std::cout << "Pushed lvalue\n";
+        else
+            std::cout << "Pushed rvalue\n";
+#endif
+    }
+
+    // Constructs the item from args right in the slot behind the last one
+    template<typename... Args>
+    T& emplaceBack(Args&&... args)
+    {
+        if (m_size < m_capacity) {
+            construct(m_data + m_size, std::forward<Args>(args)...);
+            ++m_size;
+        } else if constexpr (REALLOC) {
+            // An argument may live in the storage realloc is about to move
+            T value(std::forward<Args>(args)...);
+            reallocate(nextCapacity(m_size + 1));
+            construct(m_data + m_size, value);
+            ++m_size;
+        } else {
+            reallocateWithGap(nextCapacity(m_size + 1), m_size, 1, [&](T* gap) {
+                construct(gap, std::forward<Args>(args)...);
+            });
+        }
+        return m_data[m_size - 1];
+    }
+
+    // Constructs the item from args in slot 'pos', the items from there on
+    // move one slot to the right
+    template<typename... Args>
+    T& emplace(size_t pos, Args&&... args)
+    {
+        if (pos > m_size)
+            throw std::out_of_range("Index out of bounds");
+
+        if (pos == m_size)
+            return emplaceBack(std::forward<Args>(args)...);
+
+        if (m_size == m_capacity) {
+            // The old items stay in place until the new one is built
+            reallocateWithGap(nextCapacity(m_size + 1), pos, 1, [&](T* gap) {
+                construct(gap, std::forward<Args>(args)...);
+            });
+            return m_data[pos];
+        }
+
+        // An argument may live in the part that gets shifted
+        if ((holds(std::addressof(args), pos) || ...)) {
+            T value(std::forward<Args>(args)...);
+            shiftRight(pos, 1);
+            construct(m_data + pos, std::move(value));
+        } else {
+            shiftRight(pos, 1);
+            try {
+                construct(m_data + pos, std::forward<Args>(args)...);
+            } catch (...) {
+                closeGap(pos, 1);
+                throw;
+            }
+        }
+
+        ++m_size;
+        return m_data[pos];
+    }
+
+    template<typename U>
+    void insert(size_t pos, U&& item)
+    {
+        emplace(pos, std::forward<U>(item));
+    }
+
+    // Inserts copies of [first, last) before 'pos' with a single shift of
+    // the items behind it
+    template<typename InputIt,
+             typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert(size_t pos, InputIt first, InputIt last)
+    {
+        if (pos > m_size)
+            throw std::out_of_range("Index out of bounds");
+
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (!std::is_base_of_v<std::forward_iterator_tag, Category>) {
+            // Single pass: collect the items before making room
+            VectorBase buffer(m_alloc);
+            for (; first != last; ++first)
+                buffer.emplaceBack(*first);
+            insert(pos, std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+        } else {
+            const size_t n = std::distance(first, last);
+            if (n == 0) return;
+
+            bool aliased{};
+            if constexpr (std::is_pointer_v<InputIt>)
+                aliased = holds(first);
+
+            if (m_size + n > m_capacity) {
+                reallocateWithGap(nextCapacity(m_size + n), pos, n, [&](T* gap) {
+                    copyConstruct(first, last, gap);
+                });
+            } else if (aliased) {
+                // The range is part of this vector and may get shifted
+                VectorBase copy(m_alloc);
+                copy.reserve(n);
+                copy.insert(0, first, last);
+                insert(pos, std::make_move_iterator(copy.begin()), std::make_move_iterator(copy.end()));
+            } else {
+                shiftRight(pos, n);
+                try {
+                    copyConstruct(first, last, m_data + pos);
+                } catch (...) {
+                    closeGap(pos, n);
+                    throw;
+                }
+                m_size += n;
+            }
+        }
+    }
+
+    void insert(size_t pos, const std::initializer_list<T>& initList)
+    {
+        insert(pos, initList.begin(), initList.end());
+    }
+
+    // Appends [first, last) with at most one reallocation when the length
+    // of the range is known up front
+    template<typename InputIt,
+             typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void append(InputIt first, InputIt last)
+    {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (!std::is_base_of_v<std::forward_iterator_tag, Category>) {
+            for (; first != last; ++first)
+                emplaceBack(*first);
+        } else {
+            const size_t n = std::distance(first, last);
+            if (n == 0) return;
+
+            if (m_size + n > m_capacity) {
+                bool aliased{};
+                if constexpr (std::is_pointer_v<InputIt>)
+                    aliased = holds(first);
+
+                if (!REALLOC || aliased || usesInline()) {
+                    // The range is read before the old storage is released
+                    reallocateWithGap(nextCapacity(m_size + n), m_size, n, [&](T* gap) {
+                        copyConstruct(first, last, gap);
+                    });
+                    return;
+                }
+                reallocate(nextCapacity(m_size + n));
+            }
+
+            copyConstruct(first, last, m_data + m_size);
+            m_size += n;
+        }
+    }
+
+    void append(const std::initializer_list<T>& initList)
+    {
+        append(initList.begin(), initList.end());
+    }
+
+    // Replaces the items with [first, last). Storage that is too small is
+    // replaced by exactly enough for the range.
+    template<typename InputIt,
+             typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void assign(InputIt first, InputIt last)
+    {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (!std::is_base_of_v<std::forward_iterator_tag, Category>) {
+            clear();
+            append(first, last);
+        } else {
+            bool aliased{};
+            if constexpr (std::is_pointer_v<InputIt>)
+                aliased = first != last && holds(first);
+
+            if (aliased) {
+                VectorBase copy(first, last, m_alloc);
+                assignFrom(std::make_move_iterator(copy.begin()), std::make_move_iterator(copy.end()), copy.m_size);
+                return;
+            }
+            assignFrom(first, last, std::distance(first, last));
+        }
+    }
+
+    void assign(const std::initializer_list<T>& initList)
+    {
+        assign(initList.begin(), initList.end());
+    }
+
+    void erase(size_t pos)
+    {
+        if (pos >= m_size)
+            throw std::out_of_range("Index out of bounds");
+
+        erase(pos, pos + 1);
+    }
+
+    // Erases [first, last) with a single shift of the items behind it
+    void erase(size_t first, size_t last)
+    {
+        if (first > last || last > m_size)
+            throw std::out_of_range("Index out of bounds");
+
+        destroy(m_data + first, m_data + last);
+        shiftLeft(first, last - first);
+        m_size -= last - first;
+    }
+
+    void popBack()
+    {
+        if (m_size == 0)
+            throw std::out_of_range("Vector is empty");
+
+        --m_size;
+        destroy(m_data + m_size, m_data + m_size + 1);
+    }
+
+    // New items are value-initialized
+    void resize(size_t newSize)
+    {
+        if (newSize <= m_size) {
+            destroy(m_data + newSize, m_data + m_size);
+        } else {
+            if (newSize > m_capacity)
+                reallocate(nextCapacity(newSize));
+            valueConstruct(m_data + m_size, newSize - m_size);
+        }
+        m_size = newSize;
+    }
+
+    void resize(size_t newSize, const T& value)
+    {
+        if (newSize <= m_size) {
+            destroy(m_data + newSize, m_data + m_size);
+        } else if (newSize > m_capacity && holds(std::addressof(value))) {
+            // The value would move with the storage
+            T copy(value);
+            resize(newSize, copy);
+            return;
+        } else {
+            if (newSize > m_capacity)
+                reallocate(nextCapacity(newSize));
+            fillConstruct(m_data + m_size, newSize - m_size, value);
+        }
+        m_size = newSize;
+    }
+
+    void clear()
+    {
+        destroy(m_data, m_data + m_size);
+        m_size = 0;
+    }
+
+    void reserve(size_t newCapacity)
+    {
+        if (newCapacity <= m_capacity) return;
+
+        reallocate(newCapacity);
+    }
+
+    // Gives back the slots behind the last item, items that fit are moved
+    // back inline
+    void shrinkToFit()
+    {
+        if (usesInline() || m_capacity == m_size) return;
+
+        if (m_size == 0) {
+            releaseStorage();
+            return;
+        }
+        if constexpr (N > 0) {
+            if (m_size <= N) {
+                T* heap = m_data;
+                relocate(inlineData(), heap, m_size);
+                deallocate(heap, m_capacity);
+                m_data = inlineData();
+                m_capacity = N;
+                return;
+            }
+        }
+        reallocate(m_size);
+    }
+
+protected:
+    // Whether the items are held in the object itself
+    bool usesInline() const
+    {
+        if constexpr (N == 0)
+            return false;
+        else
+            return m_data == inlineData();
+    }
+
+private:
+    static constexpr double DEFAULT_GROWTH_FACTOR = 2.0;
+
+    size_t nextCapacity(size_t required) const
+    {
+        const size_t grown = static_cast<size_t>(m_capacity * m_growthFactor);
+        return std::max({ required, grown, m_capacity + 1 });
+    }
+
+    // Whether 'address' lies within the items [from, m_size)
+    bool holds(const void* address, size_t from = 0) const
+    {
+        const std::less<const void*> before;
+        return !before(address, m_data + from) && before(address, m_data + m_size);
+    }
+
+    // Replaces the items with the 'size' items of [first, last), reusing the
+    // storage when it is large enough and allocating exactly 'size' slots
+    // otherwise. The range must not lie within this vector.
+    template<typename It>
+    void assignFrom(It first, It last, size_t size)
+    {
+        if constexpr (TRIVIAL && isItemPointer<It>()) {
+            if (m_capacity < size) {
+                T* newData = allocate(size);
+                freeStorage();
+                m_data = newData;
+                m_capacity = size;
+            }
+            if (size)
+                std::memcpy(m_data, first, size * sizeof(T));
+            m_size = size;
+            return;
+        }
+
+        if (m_capacity >= size) {
+            const size_t common = std::min(m_size, size);
+            It rest = first;
+            for (size_t i = 0; i < common; ++i, ++rest)
+                m_data[i] = *rest;
+            if (size > m_size)
+                copyConstruct(rest, last, m_data + common);
+            else
+                destroy(m_data + common, m_data + m_size);
+            m_size = size;
+            return;
+        }
+
+        T* newData = allocate(size);
+        try {
+            copyConstruct(first, last, newData);
+        } catch (...) {
+            deallocate(newData, size);
+            throw;
+        }
+
+        destroy(m_data, m_data + m_size);
+        freeStorage();
+
+        m_data = newData;
+        m_size = size;
+        m_capacity = size;
+    }
+
+    // Moves [start, m_size) n slots to the right, [start, start + n) is left raw
+    void shiftRight(size_t start, size_t n)
+    {
+        if constexpr (TRIVIAL) {
+            std::memmove(m_data + start + n, m_data + start, (m_size - start) * sizeof(T));
+        } else {
+            for (size_t i = m_size; i > start; --i) {
+                construct(m_data + i - 1 + n, std::move_if_noexcept(m_data[i - 1]));
+                destroy(m_data + i - 1, m_data + i);
+            }
+        }
+    }
+
+    // Fills the raw slots [start, start + n) by moving [start + n, m_size)
+    // n slots to the left
+    void shiftLeft(size_t start, size_t n)
+    {
+        if (n == 0) return;
+
+        if constexpr (TRIVIAL) {
+            std::memmove(m_data + start, m_data + start + n, (m_size - start - n) * sizeof(T));
+        } else {
+            for (size_t i = start + n; i < m_size; ++i) {
+                construct(m_data + i - n, std::move_if_noexcept(m_data[i]));
+                destroy(m_data + i, m_data + i + 1);
+            }
+        }
+    }
+
+    // Undoes shiftRight(start, n) after filling the gap failed
+    void closeGap(size_t start, size_t n)
+    {
+        m_size += n;
+        shiftLeft(start, n);
+        m_size -= n;
+    }
+
+    // Moves n items into raw, non-overlapping storage
+    void relocate(T* dst, T* src, size_t n)
+    {
+        if constexpr (TRIVIAL) {
+            if (n)
+                std::memcpy(dst, src, n * sizeof(T));
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                construct(dst + i, std::move(src[i]));
+                destroy(src + i, src + i + 1);
+            }
+        }
+    }
+
+    // Takes the items of 'other', which is left empty. Heap storage changes
+    // hands, inline items are moved into this vector's inline slots, which
+    // must be empty.
+    void take(VectorBase& other)
+    {
+        if (other.usesInline()) {
+            relocate(m_data, other.m_data, other.m_size);
+            m_size = std::exchange(other.m_size, 0);
+            return;
+        }
+
+        m_data = std::exchange(other.m_data, other.inlineData());
+        m_size = std::exchange(other.m_size, 0);
+        m_capacity = std::exchange(other.m_capacity, N);
+    }
+
+    // Moves the items into heap storage for newCapacity items. A throwing
+    // copy leaves the vector as it was.
+    void reallocate(size_t newCapacity)
+    {
+        if constexpr (REALLOC) {
+            if (!usesInline()) {
+                void* newData = std::realloc(m_data, newCapacity * sizeof(T));
+                if (!newData)
+                    throw std::bad_alloc();
+                m_data = static_cast<T*>(newData);
+                m_capacity = newCapacity;
+                return;
+            }
+        }
+        reallocateWithGap(newCapacity, m_size, 0, [](T*) {});
+    }
+
+    // Moves the items into heap storage for newCapacity items, leaving n
+    // slots at 'pos' for fill(gap) to construct. The old items are only
+    // released once everything is built, so a throwing fill() or copy
+    // leaves the vector as it was.
+    template<typename Fill>
+    void reallocateWithGap(size_t newCapacity, size_t pos, size_t n, Fill fill)
+    {
+        T* newData = allocate(newCapacity);
+        try {
+            fill(newData + pos);
+        } catch (...) {
+            deallocate(newData, newCapacity);
+            throw;
+        }
+
+        if constexpr (TRIVIAL) {
+            if (pos)
+                std::memcpy(newData, m_data, pos * sizeof(T));
+            if (m_size > pos)
+                std::memcpy(newData + pos + n, m_data + pos, (m_size - pos) * sizeof(T));
+        } else {
+            const auto slot = [&](size_t i) { return newData + i + (i >= pos ? n : 0); };
+            size_t built{};
+            try {
+                for (; built < m_size; ++built)
+                    construct(slot(built), std::move_if_noexcept(m_data[built]));
+            } catch (...) {
+                for (size_t i = 0; i < built; ++i)
+                    destroy(slot(i), slot(i) + 1);
+                destroy(newData + pos, newData + pos + n);
+                deallocate(newData, newCapacity);
+                throw;
+            }
+            destroy(m_data, m_data + m_size);
+        }
+
+        freeStorage();
+        m_data = newData;
+        m_size += n;
+        m_capacity = newCapacity;
+    }
+
+    // Storage for constructors that start with 'capacity' slots, up to N of
+    // them fit inline
+    void initStorage(size_t capacity)
+    {
+        if (capacity <= N) return;
+
+        m_data = allocate(capacity);
+        m_capacity = capacity;
+    }
+
+    // Only reached from the constructors, where nothing else owns m_data
+    template<typename Construct>
+    void constructOrFree(Construct construct)
+    {
+        try {
+            construct();
+        } catch (...) {
+            freeStorage();
+            throw;
+        }
+    }
+
+    // Hands heap storage back, the items must be gone already
+    void freeStorage()
+    {
+        if (!usesInline())
+            deallocate(m_data, m_capacity);
+    }
+
+    void releaseStorage()
+    {
+        destroy(m_data, m_data + m_size);
+        freeStorage();
+        m_data = inlineData();
+        m_size = 0;
+        m_capacity = N;
+    }
+
+    template<typename... Args>
+    void construct(T* slot, Args&&... args)
+    {
+        AllocTraits::construct(m_alloc, slot, std::forward<Args>(args)...);
+    }
+
+    void destroy(T* first, T* last)
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (; first != last; ++first)
+                AllocTraits::destroy(m_alloc, first);
+        }
+    }
+
+    // Builds n items in the raw slots from dst on, the built ones are
+    // destroyed again if one of them throws
+    template<typename Build>
+    void constructEach(T* dst, size_t n, Build build)
+    {
+        size_t built{};
+        try {
+            for (; built < n; ++built)
+                build(dst + built);
+        } catch (...) {
+            destroy(dst, dst + built);
+            throw;
+        }
+    }
+
+    // Ranges given as T pointers can be copied with memcpy
+    template<typename It>
+    static constexpr bool isItemPointer()
+    {
+        return std::is_pointer_v<It> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<It>>, T>;
+    }
+
+    template<typename It>
+    void copyConstruct(It first, It last, T* dst)
+    {
+        if constexpr (TRIVIAL && isItemPointer<It>()) {
+            if (first != last)
+                std::memcpy(dst, first, (last - first) * sizeof(T));
+        } else {
+            constructEach(dst, std::distance(first, last), [&](T* slot) { construct(slot, *first++); });
+        }
+    }
+
+    void valueConstruct(T* dst, size_t n)
+    {
+        constructEach(dst, n, [&](T* slot) { construct(slot); });
+    }
+
+    void fillConstruct(T* dst, size_t n, const T& value)
+    {
+        constructEach(dst, n, [&](T* slot) { construct(slot, value); });
+    }
+
+    T* allocate(size_t capacity)
+    {
+        if (capacity == 0) return nullptr;
+
+        if constexpr (REALLOC) {
+            void* data = std::malloc(capacity * sizeof(T));
+            if (!data)
+                throw std::bad_alloc();
+            return static_cast<T*>(data);
+        } else {
+            return AllocTraits::allocate(m_alloc, capacity);
+        }
+    }
+
+    void deallocate(T* data, size_t capacity)
+    {
+        if (!data) return;
+
+        if constexpr (REALLOC)
+            std::free(data);
+        else
+            AllocTraits::deallocate(m_alloc, data, capacity);
+    }
+
+    Allocator m_alloc{};
+    size_t m_size{};
+    size_t m_capacity{ N };
+    T* m_data{ inlineData() };
+    double m_growthFactor{ DEFAULT_GROWTH_FACTOR };
+};
+
+}
+
+#endif // VECTORBASE_H
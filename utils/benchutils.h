@@ -0,0 +1,50 @@
+#ifndef BENCHUTILS_H
+#define BENCHUTILS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+// Helpers shared by the benchmarks
+namespace Bench {
+
+using Clock = std::chrono::steady_clock;
+
+// Time fn() takes per operation when it does 'ops' of them
+template <typename Fn>
+double nsPerOp(size_t ops, Fn &&fn) {
+    const auto start = Clock::now();
+    fn();
+    const auto elapsed = Clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+}
+
+template <typename Fn>
+double millis(Fn &&fn) {
+    const auto start = Clock::now();
+    fn();
+    const auto elapsed = Clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+// The i-th item of a benchmark run, benchmarks with their own item types
+// add specializations
+template <typename T> T makeItem(size_t i);
+template <> inline int makeItem<int>(size_t i)                 { return static_cast<int>(i); }
+template <> inline std::string makeItem<std::string>(size_t i) { return std::to_string(i); }
+
+// Something to sum up from every item read, so the reads cannot be dropped
+inline size_t weigh(int item)                { return static_cast<size_t>(item); }
+inline size_t weigh(const std::string &item) { return item.size(); }
+
+// Stores a result where the compiler has to assume it is looked at, so the
+// work computing it is not optimized away
+template <typename T>
+void keep(T value) {
+    static volatile T sink{};
+    sink = value;
+}
+
+}
+
+#endif // BENCHUTILS_H
@@ -0,0 +1,39 @@
+#include "tableprinter.h"
+#include <string>
+
+TablePrinter::TablePrinter(std::ostream& outStream)
+    : m_outStream{ outStream }
+{
+}
+
+void TablePrinter::addColumn(uint16_t columnWidth)
+{
+    addColumn("", columnWidth);
+}
+
+void TablePrinter::addColumn(const std::string& header, uint16_t columnWidth)
+{
+    m_headers.pushBack(header);
+    m_columnWidths.pushBack(columnWidth);
+
+    ++m_columnsNum;
+    m_tableWidth += columnWidth + 1;
+}
+
+void TablePrinter::printHeader()
+{
+    printHorizontalLine();
+
+    m_outStream << "|";
+    for (size_t i = 0; i < m_columnsNum; ++i)
+        m_outStream << std::setw(m_columnWidths[i]) << m_headers[i] << "|";
+    m_outStream << "\n";
+
+    printHorizontalLine();
+}
+
+void TablePrinter::printHorizontalLine()
+{
+    if (m_tableWidth == 0) return;
+    m_outStream << "+" << std::string(m_tableWidth - 1, '-') << "+\n";
+}
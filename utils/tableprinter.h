@@ -1,10 +1,11 @@
 #ifndef TABLEPRINTER_H
 #define TABLEPRINTER_H
 
-#include "nvector.h"
+#include "smallvector.h"
 #include <cstdint>
 #include <ostream>
 #include <iomanip>
+#include <string>
 
 class TablePrinter
 {
@@ -37,8 +38,8 @@ public:
 private:
     std::ostream& m_outStream;
 
-    NVector<std::string> m_headers{};
-    NVector<int> m_columnWidths{};
+    SmallVector<std::string, 16> m_headers{};
+    SmallVector<int, 16> m_columnWidths{};
 
     size_t m_columnsNum{};
     size_t m_tableWidth{};